@@ -6,181 +6,536 @@
 #include <chrono>
 #include <cmath>
 #include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/ActivityPower.h"
+#include "core/ControlPlane.h"
+#include "core/Gate.h"
+#include "core/InjectQueue.h"
+#include "core/InputSink.h"
+#include "core/Log.h"
+#include "core/MotionIntegrator.h"
+#include "core/Presets.h"
+#include "core/Profile.h"
+#include "core/Reactor.h"
+#define REDMOUSE_COUNT_ALLOCATIONS // operator new ของโปรแกรมนี้นับการจองหน่วยความจำแยกต่อ thread
+#include "core/RealtimeThread.h"
+#include "core/SessionLog.h"
+#include "core/Settings.h"
+#include "core/Telemetry.h"
+#include "core/TickScheduler.h"
+#include "core/Trajectory.h"
 
 #pragma comment(lib, "winmm.lib")
+#pragma comment(lib, "Avrt.lib")
+
+// ค่าที่อ่านจาก command line
+struct ControllerOptions {
+    unsigned rateHz = 100;               // --rate=<Hz>
+    unsigned spinUs = 50;                // --spin-us=<us>
+    const char* telemetryCsv = nullptr;  // --telemetry=<file.csv>
+    unsigned statsSec = 5;               // --stats=<sec> (0 = ปิด)
+    const char* profilePath = nullptr;   // --profile=<file.rmp> (ไม่ระบุ = preset ในตัวโปรแกรม)
+    bool fixedPoint = false;             // --integrator=q32: สะสมแบบ fixed-point ไม่มี drift
+    bool eventEmit = false;              // --emit=event: ตื่นเฉพาะตอนครบ 1 พิกเซล (บังคับใช้ q32)
+    const char* recordPath = nullptr;    // --record=<file.rms>: บันทึก session ไว้ replay ด้วย tools/SessionReplay
+    redmouse::RealtimeOptions realtime;  // --rt-cpu=<n>, --rt-elevate, --rt-lock, --rt
+    redmouse::InjectMode inject = redmouse::InjectMode::Direct; // --inject=batch|coalesce: ส่งต่อให้ injector thread
+    unsigned injectBudgetUs = 1000;      // --inject-budget-us=<us>: หน่วงได้สูงสุดเท่านี้เพื่อรวม move เป็น batch
+    redmouse::PowerPolicy power = redmouse::PowerPolicy::Active; // --power=always|active: timer 1ms ตลอด หรือเฉพาะตอนขยับ
+    redmouse::Logger::Options log;       // --log=<file> (ไม่ระบุ = คอนโซล), --log-level=, --log-max-kb=
+    redmouse::StartPolicy start = redmouse::StartPolicy::Zero;   // --start=zero|immediate|half|carry: ค่าเริ่มของตัวสะสมตอนกด
+    const char* controlName = nullptr;   // --control[=<name>]: เปิด shared memory ให้ tools/ControlTool สั่งงานและอ่านสถานะ
+};
 
 class MouseController {
 private:
-    std::atomic<bool> enabled{ false };
+    static constexpr int64_t  kCurveStrokeNs = 10000000; // เส้นโค้งหนึ่งเส้นยาว 10ms เท่าของเดิม
+    static constexpr uint32_t kCurveRateHz   = 1000;     // 10 จุดต่อเส้นโค้ง
+    static constexpr int64_t  kMaxEventSleepNs = 250000000; // --emit=event: หลับนานสุดต่อรอบ (เช่น sensitivity 0)
+    static constexpr int64_t  kSelfCheckNs = 250000000;     // วัด jitter ตอนเริ่ม 250ms ก่อนเข้าลูปจริง
+    // ทุกข้อความผ่าน logger: thread ที่เรียกแค่คัด record ลง ring ของตัวเอง ส่วนการเขียนคอนโซล/ไฟล์ทำใน drain thread
+    // ประกาศไว้ก่อน member อื่น จึงถูกทำลายหลังสุด
+    redmouse::Logger log;
     std::atomic<bool> running{ true };
-    std::atomic<double> sensitivity{ 1.0551 }; // Default sensitivity
-    std::atomic<bool> useCurvePattern{ false };
+    // enabled / sensitivity / curve mode อยู่ใน snapshot เดียว: motion thread อ่านครั้งเดียวต่อ tick ไม่มีค่าฉีกขาด
+    redmouse::SettingsCell settings;
+    // ตาราง F2-F9 จาก profile (หรือค่าในตัว) ส่วน curve ที่ compile แล้วส่งให้ motion thread ผ่าน handoff
+    redmouse::Seqlock<redmouse::PresetTable> presets{ redmouse::PresetTable::builtIn() };
+    redmouse::ProfileHandoff profiles;
+    redmouse::FileWatcher profileWatcher;
+    std::unique_ptr<redmouse::InputSink> sink;
+    redmouse::QueuedSink* queue = nullptr; // ชี้เข้า sink เมื่อใช้ --inject ไม่งั้นเป็น nullptr
+    redmouse::Reactor reactor{ [this](const redmouse::InputEvent& e) { onInput(e); } };
+    redmouse::Gate motionGate; // เปิดเมื่อ enabled และกดปุ่มซ้ายค้าง
+    redmouse::WakeEvent motionWake; // ปลุก motion thread ที่หลับรอพิกเซลถัดไป เมื่อค่าหรือ gate เปลี่ยน
+    redmouse::TickScheduler<redmouse::SteadyClock>::Config tickConfig;
+    redmouse::Telemetry telemetry;
+    redmouse::SessionRecorder recorder; // ทำงานเฉพาะเมื่อมี --record
+    redmouse::ControlPlane control;     // ทำงานเฉพาะเมื่อมี --control: mailbox คำสั่ง + สถานะสด ใน shared memory
+    uint64_t loopAllocations = 0;       // จำนวน operator new ใน motion loop (ต้องเป็น 0) อ่านหลัง join
+    ControllerOptions options;
+    redmouse::ActivityPower power; // timeBeginPeriod(1) เฉพาะช่วงที่ gate เปิด (ค่าเริ่มต้น)
     HANDLE hConsole;
 
     void initConsole() {
         hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
     }
 
-    void setColor(const char* color) {
-        printf("%s", color);
-    }
-
-    void printWithColor(const char* color, const char* text) {
-        setColor(color);
-        printf("%s", text);
-        setColor("\033[0m"); // Reset color
+    // ทุกการเปลี่ยนค่าผ่านที่นี่: ถ้า motion thread หลับรอพิกเซลถัดไปอยู่ จะตื่นมาคำนวณเวลาใหม่ทันที
+    template <class Fn>
+    redmouse::MotionSettings publish(Fn&& fn) {
+        const redmouse::MotionSettings s = settings.update(std::forward<Fn>(fn));
+        motionWake.signal();
+        return s;
     }
 
     // ตั้งค่าความไวพร้อมแสดงผลในคอนโซล
     void setSensitivity(double value) {
-        sensitivity = value;
-        printWithColor("\033[93m", "Sensitivity set to: ");
-        printf("%.7f\n", value);
+        publish([&](redmouse::MotionSettings& s) { s.sensitivity = value; });
+        printSensitivity(value);
+    }
+
+    // ปรับแบบ read-modify-write ใน snapshot เดียว กดรัวจากหลาย thread ก็ไม่ทำค่าหาย
+    void stepSensitivity(double delta) {
+        const redmouse::MotionSettings s = publish([&](redmouse::MotionSettings& cur) {
+            cur.sensitivity = redmouse::clampSensitivity(cur.sensitivity + delta);
+        });
+        printSensitivity(s.sensitivity);
     }
 
-    // ฟังก์ชัน interpolation แบบ quadratic Bezier
-    // รับค่า start, control, end และ t (0 <= t <= 1)
-    POINT bezierInterpolation(const POINT& start, const POINT& control, const POINT& end, double t) {
-        double u = 1.0 - t;
-        double tt = t * t;
-        double uu = u * u;
-        POINT result;
-        result.x = static_cast<LONG>(uu * start.x + 2 * u * t * control.x + tt * end.x);
-        result.y = static_cast<LONG>(uu * start.y + 2 * u * t * control.y + tt * end.y);
-        return result;
+    // preset เลือกได้ทั้งความไวและ curve ในการ publish ครั้งเดียว
+    void applyPreset(int index) {
+        const redmouse::PresetTable t = presets.load();
+        if (index >= t.count) return;
+        const redmouse::PresetTable::Entry& p = t.entries[index];
+        publish([&](redmouse::MotionSettings& s) {
+            s.sensitivity = redmouse::clampSensitivity(p.sensitivity);
+            s.curve = p.curve;
+        });
+        log.info("\033[93mPreset \033[0m%s: \033[93mSensitivity set to: \033[0m%.7f\n", p.name, p.sensitivity);
+    }
+
+    // เรียกตอนเริ่มและจาก watcher thread เมื่อไฟล์เปลี่ยน: ไฟล์เสียจะถูกปฏิเสธและใช้ของเดิมต่อ
+    bool loadProfile() {
+        std::string error;
+        std::unique_ptr<redmouse::Profile> p = redmouse::Profile::load(options.profilePath, &error);
+        if (!p) {
+            log.warn("\033[91mProfile rejected: \033[0m%s (%s)\n", options.profilePath, error);
+            return false;
+        }
+        const redmouse::PresetTable t = p->hotkeys();
+        log.info("\033[92mProfile loaded: \033[0m%s (%zu presets, %zu curves)\n", options.profilePath,
+            p->presetCount(), p->curveCount());
+        presets.store(t);
+        profiles.offer(std::move(p));
+        return true;
+    }
+
+    void printSensitivity(double value) {
+        log.info("\033[93mSensitivity set to: \033[0m%.7f\n", value);
     }
 
     void mouseThread() {
-        using namespace std::chrono;
         // ตั้ง priority สูงสำหรับ thread นี้
         SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+        // pin CPU / MMCSS / lock memory ตาม --rt-* แล้ววัด jitter จริงของเครื่องนี้ก่อนเริ่มทำงาน
+        redmouse::RealtimeScope rt(options.realtime);
+        redmouse::TickScheduler<redmouse::SteadyClock> scheduler(tickConfig);
+        // self-check ใช้ timer resolution เดียวกับตอนทำงานจริง; ถ้าไม่มีใครกด จะถูกปล่อยหลัง linger
+        power.raise();
+        const redmouse::SelfCheckResult check = redmouse::tickSelfCheck(scheduler, kSelfCheckNs);
+        log.info("\033[90mMotion thread: %s; self-check %llu ticks, jitter p50/p99/max=%.0f/%.0f/%.0fus, missed=%llu, alloc=%llu\033[0m\n",
+            rt.describe(), check.ticks, check.p50Ns / 1e3, check.p99Ns / 1e3, check.maxNs / 1e3,
+            check.missed, check.allocations);
+        if (options.fixedPoint) runMotion<redmouse::FixedPointIntegrator>(scheduler);
+        else runMotion<redmouse::FixedStepIntegrator>(scheduler);
+    }
 
-        auto nextTick = steady_clock::now();
-        const double dt = 0.01; // ระยะเวลาของ tick = 10ms
-        double pixelAccumulator = 0.0;
-        const double maxSpeed = 40.0; // เมื่อ sensitivity = 1.0 -> 40px/s
+    // ลูปหลักแยกจาก clock จริง: ใส่ VirtualClock เพื่อทดสอบ timing โดยไม่ต้องรอเวลาจริง
+    // Integrator: FixedStepIntegrator (dt = คาบของ tick, ค่าเริ่มต้น 10ms) หรือ FixedPointIntegrator (--integrator=q32)
+    // sensitivity 1.0 -> 40px/s ทั้งสองแบบ
+    template <class Integrator, class Clock>
+    void runMotion(redmouse::TickScheduler<Clock>& scheduler) {
+        Integrator integrator;
+        const int64_t startNs = scheduler.clock().nowNs();
+        integrator.start(startNs, options.start);
+        recorder.resume(startNs);
+        uint64_t loggedVersion = ~uint64_t(0);
+        // Curve Pattern: แต่ละก้อนพิกเซลกลายเป็น stroke ยาว 10ms ที่เล่นทีละ tick (ไม่มี sleep ในลูป)
+        const redmouse::Trajectory curveShape = redmouse::Trajectory::legacyBob();
+        redmouse::CurvePlayer curve(&curveShape, kCurveStrokeNs);
+        std::unique_ptr<redmouse::Profile> profile; // ของ motion thread เท่านั้น; ตัวเก่าคืนผ่าน retire() ไม่ free ในลูปนี้
+        const uint64_t allocBase = redmouse::threadAllocations(); // ทุกอย่างจองไว้ก่อนถึงบรรทัดนี้
 
         while (running) {
-            if (enabled && (GetAsyncKeyState(VK_LBUTTON) & 0x8000)) {
-                double currentSensitivity = sensitivity.load();
-                double speed = currentSensitivity * maxSpeed;
-                pixelAccumulator += speed * dt;
-                int movePixels = static_cast<int>(pixelAccumulator);
-
-                if (movePixels > 0) {
-                    if (useCurvePattern.load()) {
-                        // โหมด Curve Pattern: ใช้ interpolation แบบ Bezier
-                        POINT startPos;
-                        GetCursorPos(&startPos);
-                        // กำหนดตำแหน่งปลายเป้าหมาย: เคลื่อนที่ในแนวตั้ง
-                        POINT targetPos = { startPos.x, startPos.y + movePixels };
-                        // กำหนด control point (ปรับแต่งได้ตามความต้องการ)
-                        POINT controlPos = { startPos.x, startPos.y + movePixels / 2 - 5 };
-                        const int steps = 10;
-                        for (int i = 1; i <= steps; ++i) {
-                            double t = static_cast<double>(i) / steps;
-                            POINT interpolated = bezierInterpolation(startPos, controlPos, targetPos, t);
-                            SetCursorPos(interpolated.x, interpolated.y);
-                            std::this_thread::sleep_for(milliseconds(1));
-                        }
-                    }
-                    else {
-                        // โหมดปกติ: ใช้ SendInput() เพื่อเลื่อนเคอร์เซอร์แบบ relative
-                        INPUT input = { 0 };
-                        input.type = INPUT_MOUSE;
-                        input.mi.dx = 0; // ไม่มีการเคลื่อนที่ในแนวนอน
-                        input.mi.dy = movePixels; // เคลื่อนที่ในแนวตั้ง
-                        input.mi.dwFlags = MOUSEEVENTF_MOVE;
-                        SendInput(1, &input, sizeof(INPUT));
-                    }
-                    pixelAccumulator -= movePixels;
-                }
+            if (!motionGate.isOpen()) {
+                // ปล่อยปุ่ม: ส่งส่วนที่เหลือของ stroke ให้จบ แล้วหลับรอ (ไม่ใช้ CPU ระหว่างรอ)
+                // หยุดนานเกิน linger จะคืน timer 1ms ให้ระบบ แล้วขอใหม่ตอนกดครั้งถัดไป
+                flushCurve(curve, scheduler.clock().nowNs());
+                if (!power.park(motionGate)) break;
+                scheduler.reset();
+                // รีเซ็ตเวลาหลังตื่น: โหมดวัดเวลาจริงจะได้ไม่นับช่วงที่หลับเป็นระยะทาง
+                // ตัวสะสมเริ่มตาม --start (zero = ต้องเดินครบ 1 พิกเซลก่อน, immediate = ขยับใน tick แรก)
+                const int64_t now = scheduler.clock().nowNs();
+                integrator.start(now, options.start);
+                recorder.resume(now);
             }
-            else {
-                // รีเซ็ต accumulator เมื่อไม่มีการกดปุ่มซ้าย
-                pixelAccumulator = 0.0;
+            const uint64_t version = settings.version();
+            const redmouse::MotionSettings cfg = settings.load();
+            if (version != loggedVersion) {
+                loggedVersion = version;
+                recorder.settings(scheduler.clock().nowNs(), cfg);
             }
-            nextTick += milliseconds(10);
-            std::this_thread::sleep_until(nextTick);
-        }
-    }
-
-    void keyboardThread() {
-        while (running) {
-            // Toggle เปิด/ปิดด้วย F1
-            if (GetAsyncKeyState(VK_F1) & 1) {
-                enabled = !enabled;
-                printWithColor(enabled ? "\033[92m" : "\033[91m",
-                    enabled ? "Status: ENABLED\n" : "Status: DISABLED\n");
+            const bool curveMode = cfg.curvePattern;
+            // profile ใหม่จาก hot reload: สลับที่ขอบ tick หลังส่ง stroke เดิมให้จบ
+            if (redmouse::Profile* next = profiles.take()) {
+                flushCurve(curve, scheduler.clock().nowNs());
+                curve.setTrajectory(&curveShape);
+                curve.setStrokeNs(kCurveStrokeNs); // ความยาว stroke ของ profile เก่าต้องไม่ติดไปกับ curveShape
+                profiles.retire(profile.release());
+                profile.reset(next);
             }
-            // กำหนด sensitivity (0-1) ผ่าน F2-F9
-            if (GetAsyncKeyState(VK_F2) & 1) setSensitivity(0.8571);
-            if (GetAsyncKeyState(VK_F3) & 1) setSensitivity(1.408);
-            if (GetAsyncKeyState(VK_F4) & 1) setSensitivity(1.15);
-            if (GetAsyncKeyState(VK_F5) & 1) setSensitivity(1.89965);
-            if (GetAsyncKeyState(VK_F6) & 1) setSensitivity(1.72225);
-            if (GetAsyncKeyState(VK_F7) & 1) setSensitivity(12.89035);
-            if (GetAsyncKeyState(VK_F8) & 1) setSensitivity(1.35955);
-            if (GetAsyncKeyState(VK_F9) & 1) setSensitivity(2.29865);
-            // F10: สลับเปิด/ปิด Curve Pattern พร้อมแสดงสถานะ
-            if (GetAsyncKeyState(VK_F10) & 1) {
-                useCurvePattern = !useCurvePattern;
-                printWithColor("\033[93m", "Curve Pattern: ");
-                printf("%s\n", useCurvePattern ? "ON" : "OFF");
+            const redmouse::Trajectory* shape = profile ? profile->curve(cfg.curve) : nullptr;
+            if (!shape) shape = &curveShape;
+            if (shape != curve.trajectory()) {
+                flushCurve(curve, scheduler.clock().nowNs());
+                curve.setTrajectory(shape);
+                curve.setStrokeNs(shape == &curveShape ? kCurveStrokeNs : profile->strokeNs(cfg.curve));
             }
-            // Numpad + และ -: ปรับค่า sensitivity แบบละเอียด โดยมีค่า max sensitivity = 20.0
-            if (GetAsyncKeyState(VK_ADD) & 1) {
-                double newVal = std::min(20.0, sensitivity.load() + 0.00005);
-                setSensitivity(newVal);
+            // โหมด Curve ต้องการ tick ถี่พอจะวาดเส้นโค้ง: อย่างน้อย kCurveRateHz
+            const uint32_t wantHz = curveMode ? std::max(options.rateHz, kCurveRateHz) : options.rateHz;
+            if (scheduler.config().rateHz != wantHz) {
+                scheduler.setRate(wantHz);
+                scheduler.reset();
             }
-            if (GetAsyncKeyState(VK_SUBTRACT) & 1) {
-                double newVal = std::max(0.0, sensitivity.load() - 0.00005);
-                setSensitivity(newVal);
+            if (!curveMode) flushCurve(curve, scheduler.clock().nowNs());
+
+            // tick ที่หลุดเกินโควตา catch-up จะถูกรวมเข้า tick นี้ ระยะทางจึงไม่หาย
+            // --emit=event ใช้ tick ตามปกติเฉพาะโหมด Curve (ต้องวาดเส้นโค้งทีละจุด)
+            const redmouse::Tick tick = nextTick(scheduler, integrator, cfg.sensitivity, options.eventEmit && !curveMode);
+            const redmouse::StepResult step = integrator.step(cfg.sensitivity, tick);
+            recorder.tick(tick, step.dy);
+
+            redmouse::TickRecord rec{ tick.scheduledNs, tick.actualNs, step.dt, 0.0f, 0, 0, step.flags };
+            int dx = 0, dy = step.dy;
+            if (curveMode) {
+                if (step.dy > 0) curve.start(tick.actualNs, 0, step.dy);
+                curve.advance(tick.actualNs, dx, dy);
+                if (dx != 0 || dy != step.dy) recorder.move(tick.actualNs, dx, dy);
             }
-            // ESC: ออกจากโปรแกรม
-            if (GetAsyncKeyState(VK_ESCAPE) & 1) {
-                running = false;
+            if (dx != 0 || dy != 0) {
+                const int64_t injectStart = scheduler.clock().nowNs();
+                // เลื่อนเคอร์เซอร์แบบ relative ผ่าน sink (SendInput โดยปริยาย) ทั้งสองโหมด
+                sink->moveRelative(dx, dy);
+                rec.injectNs = uint32_t(scheduler.clock().nowNs() - injectStart);
+                rec.dy = dy;
             }
-            Sleep(10);
+            rec.acc = float(integrator.accumulator());
+            telemetry.record(rec);
+        }
+        flushCurve(curve, scheduler.clock().nowNs());
+        profiles.retire(profile.release());
+        loopAllocations = redmouse::threadAllocations() - allocBase;
+    }
+
+    // --emit=event: หลับจนถึงเวลาที่ accumulator จะครบพิกเซลถัดไป แทนการตื่นทุก tick
+    // ถ้าถูกปลุกก่อน (เปลี่ยนค่า/ปล่อยปุ่ม) tick นั้นยังคิดระยะด้วยค่าเดิมจนถึงเวลาที่ตื่น แล้วรอบถัดไปคำนวณ deadline ใหม่
+    template <class Integrator, class Clock>
+    redmouse::Tick nextTick(redmouse::TickScheduler<Clock>& scheduler, Integrator& integrator, double sensitivity,
+                            bool eventMode) {
+        if constexpr (std::is_same<Integrator, redmouse::FixedPointIntegrator>::value) {
+            if (eventMode) {
+                const int64_t cap = scheduler.clock().nowNs() + kMaxEventSleepNs;
+                return scheduler.waitUntil(std::min(integrator.nextPixelNs(sensitivity), cap), &motionWake);
+            }
+        }
+        (void)integrator; (void)sensitivity; (void)eventMode;
+        return scheduler.wait();
+    }
+
+    void flushCurve(redmouse::CurvePlayer& curve, int64_t nowNs) {
+        if (!curve.active()) return;
+        int dx, dy;
+        curve.finish(dx, dy);
+        sink->moveRelative(dx, dy);
+        recorder.move(nowNs, dx, dy);
+    }
+
+    void printTelemetry(const redmouse::TelemetrySnapshot& s) {
+        log.info("\033[90m[tick] n=%llu px=%llu jitter p50/p99/p99.9=%.0f/%.0f/%.0fus inject p99=%.1fus missed=%llu drop=%llu\033[0m\n",
+            s.ticks, s.pixels, s.jitterP50 / 1e3, s.jitterP99 / 1e3, s.jitterP999 / 1e3, s.injectP99 / 1e3,
+            s.missedTicks, s.dropped);
+    }
+
+    void refreshGate() {
+        motionGate.set(settings.load().enabled && reactor.isDown(redmouse::Key::LButton));
+        motionWake.signal();
+    }
+
+    // เรียกจาก reactor thread เมื่อมี edge ของปุ่มจริง (ไม่มีการ polling)
+    void onInput(const redmouse::InputEvent& e) {
+        using redmouse::Key;
+        recorder.input(e);
+        if (e.key == Key::LButton) { refreshGate(); return; }
+        if (!e.down) return;
+
+        switch (e.key) {
+        // Toggle เปิด/ปิดด้วย F1
+        case Key::F1: {
+            const bool on = publish([](redmouse::MotionSettings& s) { s.enabled = !s.enabled; }).enabled;
+            refreshGate();
+            log.info(on ? "\033[92mStatus: ENABLED\033[0m\n" : "\033[91mStatus: DISABLED\033[0m\n");
+            break;
+        }
+        // กำหนด sensitivity ผ่าน F2-F9 (ตารางจาก profile หรือ core/Presets.h)
+        case Key::F2: case Key::F3: case Key::F4: case Key::F5:
+        case Key::F6: case Key::F7: case Key::F8: case Key::F9:
+            applyPreset(int(e.key) - int(Key::F2));
+            break;
+        // F10: สลับเปิด/ปิด Curve Pattern พร้อมแสดงสถานะ
+        case Key::F10: {
+            const bool on = publish([](redmouse::MotionSettings& s) { s.curvePattern = !s.curvePattern; }).curvePattern;
+            log.info("\033[93mCurve Pattern: \033[0m%s\n", on ? "ON" : "OFF");
+            break;
+        }
+        // Numpad + และ -: ปรับค่า sensitivity แบบละเอียด โดยมีค่า max sensitivity = 20.0
+        case Key::Add:
+            stepSensitivity(+redmouse::kSensitivityStep);
+            break;
+        case Key::Subtract:
+            stepSensitivity(-redmouse::kSensitivityStep);
+            break;
+        // ESC: ออกจากโปรแกรม
+        case Key::Escape:
+            requestExit();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void requestExit() {
+        running = false;
+        motionGate.release();
+        motionWake.signal();
+    }
+
+    // เรียกจาก service thread ของ control plane: ผลเหมือนกดปุ่มลัด คืน false เมื่อคำสั่งใช้ไม่ได้ (นับเป็น rejected)
+    bool onControl(const redmouse::ControlCommand& c) {
+        using redmouse::ControlOp;
+        switch (c.op) {
+        case ControlOp::SetEnabled:
+        case ControlOp::Toggle: {
+            const bool on = publish([&](redmouse::MotionSettings& s) {
+                s.enabled = c.op == ControlOp::Toggle ? !s.enabled : c.arg != 0;
+            }).enabled;
+            refreshGate();
+            log.info(on ? "\033[92mStatus: ENABLED\033[0m (control)\n" : "\033[91mStatus: DISABLED\033[0m (control)\n");
+            return true;
+        }
+        case ControlOp::SetSensitivity:
+            if (!std::isfinite(c.value)) return false;
+            setSensitivity(redmouse::clampSensitivity(c.value));
+            return true;
+        case ControlOp::StepSensitivity:
+            if (!std::isfinite(c.value)) return false;
+            stepSensitivity(c.value);
+            return true;
+        case ControlOp::Preset:
+            if (c.arg < 0 || c.arg >= presets.load().count) return false;
+            applyPreset(c.arg);
+            return true;
+        case ControlOp::SetCurvePattern:
+            publish([&](redmouse::MotionSettings& s) { s.curvePattern = c.arg != 0; });
+            log.info("\033[93mCurve Pattern: \033[0m%s (control)\n", c.arg ? "ON" : "OFF");
+            return true;
+        case ControlOp::Quit:
+            requestExit();
+            return true;
+        default:
+            return false;
         }
     }
 
     void printHeader() {
         system("cls");
-        printWithColor("\033[96m", "+--------------------------------+\n");
-        printWithColor("\033[96m", "|      Mouse Movement Controller      |\n");
-        printWithColor("\033[96m", "+--------------------------------+\n\n");
-        printWithColor("\033[93m", "Controls:\n");
-        printf("----------------------------------\n");
-        printWithColor("\033[97m", "F1");   printf(": Toggle Control\n");
-        printWithColor("\033[97m", "F2-F9"); printf(": Set Sensitivity (presets)\n");
-        printWithColor("\033[97m", "F10");  printf(": Toggle Curve Pattern\n");
-        printWithColor("\033[97m", "Numpad +/-");  printf(": Fine-tune Sensitivity\n");
-        printWithColor("\033[97m", "ESC");  printf(": Exit\n\n");
+        log.info("\033[96m+--------------------------------+\n"
+                 "|      Mouse Movement Controller      |\n"
+                 "+--------------------------------+\033[0m\n\n");
+        log.info("\033[93mControls:\033[0m\n"
+                 "----------------------------------\n"
+                 "\033[97mF1\033[0m: Toggle Control\n"
+                 "\033[97mF2-F9\033[0m: Set Sensitivity (presets)\n"
+                 "\033[97mF10\033[0m: Toggle Curve Pattern\n"
+                 "\033[97mNumpad +/-\033[0m: Fine-tune Sensitivity\n"
+                 "\033[97mESC\033[0m: Exit\n\n");
     }
 
 public:
-    MouseController() {
+    MouseController(std::unique_ptr<redmouse::InputSink> s, const ControllerOptions& opt)
+        : sink(std::move(s)), options(opt), power(redmouse::ActivityPower::Options{ opt.power }) {
+        tickConfig.rateHz = opt.rateHz;
+        tickConfig.spinNs = int64_t(opt.spinUs) * 1000;
+        // tick ที่ตื่นช้า (OS หน่วง): ยิง tick ที่ค้างติดกันได้สูงสุด 10 ครั้ง ส่วนที่เกินรวมเป็น missed
+        tickConfig.overrun = redmouse::Overrun::CatchUp;
+        tickConfig.maxCatchUp = 10;
+        if (opt.inject != redmouse::InjectMode::Direct) {
+            redmouse::QueuedSink::Options qo;
+            qo.mode = opt.inject;
+            qo.budgetNs = int64_t(opt.injectBudgetUs) * 1000;
+            auto q = std::make_unique<redmouse::QueuedSink>(std::move(sink), qo);
+            queue = q.get();
+            sink = std::move(q);
+        }
         initConsole();
     }
 
     void run() {
+        const bool logOpened = log.start(options.log);
         printHeader();
-        printWithColor("\033[91m", "Status: DISABLED\n");
-        printf("Initial sensitivity: %.7f\n\n", sensitivity.load());
-        timeBeginPeriod(1);
+        if (!logOpened) log.warn("Cannot open log file: %s (logging to the console)\n", options.log.path);
+        log.info("\033[91mStatus: DISABLED\033[0m\n");
+        log.info("Initial sensitivity: %.7f\n", settings.load().sensitivity);
+        log.info("Tick rate: %u Hz, integrator: %s, emit: %s, inject: %s, start: %s\n\n", tickConfig.rateHz,
+            options.fixedPoint ? "q32" : "fixed", options.eventEmit ? "event" : "tick",
+            redmouse::injectModeName(options.inject), redmouse::startPolicyName(options.start));
+        if (!reactor.start()) {
+            log.error("\033[91mFailed to install input hooks.\033[0m\n");
+            return;
+        }
+        if (options.profilePath) {
+            loadProfile();
+            if (!profileWatcher.start(options.profilePath, [this] { loadProfile(); }))
+                log.warn("Cannot watch profile: %s\n", options.profilePath);
+        }
+        redmouse::Telemetry::Options topt;
+        if (options.telemetryCsv && !(topt.csv = fopen(options.telemetryCsv, "w")))
+            log.warn("Cannot open telemetry file: %s\n", options.telemetryCsv);
+        topt.reportIntervalMs = options.statsSec * 1000;
+        topt.onReport = [this](const redmouse::TelemetrySnapshot& s) { printTelemetry(s); };
+        telemetry.start(std::move(topt));
+        if (options.recordPath) {
+            const redmouse::SessionIntegrator kind = options.fixedPoint ? redmouse::SessionIntegrator::FixedPoint
+                                                                        : redmouse::SessionIntegrator::Fixed;
+            FILE* f = fopen(options.recordPath, "wb");
+            if (!f || !recorder.start(f, tickConfig.rateHz, kind, options.eventEmit, redmouse::steadyNowNs(), options.start))
+                log.warn("Cannot record session: %s\n", options.recordPath);
+        }
+        if (options.controlName) {
+            redmouse::ControlPlane::Options co;
+            co.name = options.controlName;
+            std::string error;
+            const bool ok = control.start(co, [this](const redmouse::ControlCommand& c) { return onControl(c); },
+                [this](redmouse::ControlStatus& s) {
+                    s.settings = settings.load();
+                    s.settingsVersion = settings.version();
+                    s.telemetry = telemetry.snapshot();
+                }, &error);
+            if (ok) log.info("Control plane: %s\n", co.name);
+            else log.warn("Control plane unavailable: %s\n", error);
+        }
+
         std::thread mouse(&MouseController::mouseThread, this);
-        std::thread keyboard(&MouseController::keyboardThread, this);
         mouse.join();
-        keyboard.join();
-        timeEndPeriod(1);
-        printWithColor("\033[93m", "\nProgram terminated.\n");
+        if (control.active()) {
+            control.stop();
+            log.info("Control plane: %llu commands, %llu rejected\n", control.applied(), control.refused());
+        }
+        profileWatcher.stop();
+        reactor.stop();
+        if (recorder.active()) {
+            recorder.stop();
+            log.info("Session log %s: %llu bytes, %llu records lost\n", options.recordPath,
+                recorder.bytesWritten(), recorder.dropped());
+        }
+        power.drop();
+        telemetry.stop();
+        printTelemetry(telemetry.snapshot());
+        if (queue) queue->stop(); // ส่ง move ที่ค้างในคิวให้หมดก่อนอ่านตัวนับ
+        redmouse::SinkStats st = queue ? queue->backend().stats() : sink->stats();
+        log.info("Sink %s: %llu moves, %llu syscalls, %llu px\n", sink->name(), st.calls, st.syscalls, st.pixels);
+        if (queue) {
+            const redmouse::InjectorStats q = queue->injectorStats();
+            if (q.backendSyscalls)
+                log.info("Injector: %llu moves in %llu batches, %llu syscalls saved, %llu dropped, delay p99=%.0fus max=%.0fus\n",
+                    q.moves, q.batches, q.syscallsSaved, q.dropped, q.delayP99Ns / 1e3, q.delayMaxNs / 1e3);
+            else // mock: ไม่มี syscall ให้ประหยัด
+                log.info("Injector: %llu moves in %llu batches, %llu dropped, delay p99=%.0fus max=%.0fus\n",
+                    q.moves, q.batches, q.dropped, q.delayP99Ns / 1e3, q.delayMaxNs / 1e3);
+        }
+        log.info("Motion loop allocations: %llu\n", loopAllocations);
+        const redmouse::PowerStats ps = power.stats();
+        log.info("Power (%s): timer 1ms held %.1f%% of %.0f s, %llu activations, motion thread parked %.1f%%, ~%llu timer interrupts avoided\n",
+            redmouse::powerPolicyName(options.power), ps.totalNs ? 100.0 * double(ps.heldNs) / double(ps.totalNs) : 0.0,
+            ps.totalNs / 1e9, ps.activations,
+            ps.totalNs ? 100.0 * double(ps.parkedNs) / double(ps.totalNs) : 0.0, ps.timerInterruptsAvoided);
+        // ต้นทุนของ logger เอง: ns ต่อการเรียกฝั่ง thread ที่ log (สุ่มวัดทุก 64 ครั้ง) และ record ที่ ring เต็มจนทิ้ง
+        const redmouse::LogStats ls = log.stats();
+        log.info("Log (%s): %llu records from %llu threads, %llu dropped, ~%.0f ns per call, drain %.0f ns per record\n",
+            redmouse::logLevelName(log.level()), ls.records, ls.threads, ls.dropped, ls.producerNs, ls.drainNs);
+        log.info("\033[93m\nProgram terminated.\033[0m\n");
+        log.stop();
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
     SetConsoleTitle(L"Mouse Movement Controller");
-    MouseController controller;
+    // --sink=sendinput|mock (default: sendinput)
+    // --rate=<Hz> tick rate 50-8000 (default: 100), --spin-us=<us> spin tail per tick (default: 50)
+    // --telemetry=<file.csv> per-second tick stats, --stats=<sec> console report interval (default: 5, 0 = off)
+    // --profile=<file.rmp> presets + curves, reloaded when the file changes
+    // --integrator=fixed|q32 (default: fixed) q32 = Q32.32 fixed-point against the wall clock
+    // --emit=tick|event (default: tick) event = wake only when the next whole pixel is due (implies q32)
+    // --record=<file.rms> capture input edges, settings and every tick for tools/SessionReplay
+    // --rt-cpu=<n> pin the motion thread, --rt-elevate MMCSS "Pro Audio", --rt-lock lock memory + prefault stack,
+    // --rt = --rt-elevate --rt-lock
+    // --inject=direct|batch|coalesce (default: direct) queue moves to an injector thread that batches them,
+    // --inject-budget-us=<us> longest a queued move may wait for a batch (default: 1000)
+    // --power=active|always (default: active) hold the 1 ms timer period only while motion is active, or for the whole run
+    // --start=zero|immediate|half|carry (default: zero) accumulator on each press: empty, one whole pixel (first tick
+    // moves), half a pixel (rounds), or the fraction left by the previous hold
+    // --log=<file> rotating log file instead of the console, --log-max-kb=<kb> rotate size (default: 1024),
+    // --log-level=debug|info|warn|error|off (default: info)
+    // --control[=<name>] shared-memory mailbox + status block for tools/ControlTool (default name: default)
+    const char* sinkKind = nullptr;
+    ControllerOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--sink=", 7) == 0) sinkKind = argv[i] + 7;
+        else if (strncmp(argv[i], "--rate=", 7) == 0) opt.rateHz = std::min(8000, std::max(50, atoi(argv[i] + 7)));
+        else if (strncmp(argv[i], "--spin-us=", 10) == 0) opt.spinUs = std::min(1000, std::max(0, atoi(argv[i] + 10)));
+        else if (strncmp(argv[i], "--telemetry=", 12) == 0) opt.telemetryCsv = argv[i] + 12;
+        else if (strncmp(argv[i], "--stats=", 8) == 0) opt.statsSec = std::max(0, atoi(argv[i] + 8));
+        else if (strncmp(argv[i], "--profile=", 10) == 0) opt.profilePath = argv[i] + 10;
+        else if (strcmp(argv[i], "--integrator=q32") == 0) opt.fixedPoint = true;
+        else if (strcmp(argv[i], "--emit=event") == 0) opt.eventEmit = opt.fixedPoint = true;
+        else if (strncmp(argv[i], "--record=", 9) == 0) opt.recordPath = argv[i] + 9;
+        else if (strncmp(argv[i], "--rt-cpu=", 9) == 0) opt.realtime.cpu = atoi(argv[i] + 9);
+        else if (strcmp(argv[i], "--rt-elevate") == 0) opt.realtime.elevate = true;
+        else if (strcmp(argv[i], "--rt-lock") == 0) opt.realtime.lockMemory = true;
+        else if (strcmp(argv[i], "--rt") == 0) opt.realtime.elevate = opt.realtime.lockMemory = true;
+        else if (strcmp(argv[i], "--inject=batch") == 0) opt.inject = redmouse::InjectMode::Batch;
+        else if (strcmp(argv[i], "--inject=coalesce") == 0) opt.inject = redmouse::InjectMode::Coalesce;
+        else if (strcmp(argv[i], "--power=always") == 0) opt.power = redmouse::PowerPolicy::Always;
+        else if (strcmp(argv[i], "--power=active") == 0) opt.power = redmouse::PowerPolicy::Active;
+        else if (strncmp(argv[i], "--start=", 8) == 0) redmouse::parseStartPolicy(argv[i] + 8, opt.start);
+        else if (strcmp(argv[i], "--control") == 0) opt.controlName = "default";
+        else if (strncmp(argv[i], "--control=", 10) == 0) opt.controlName = argv[i] + 10;
+        else if (strncmp(argv[i], "--log=", 6) == 0) opt.log.path = argv[i] + 6;
+        else if (strncmp(argv[i], "--log-level=", 12) == 0) redmouse::parseLogLevel(argv[i] + 12, opt.log.level);
+        else if (strncmp(argv[i], "--log-max-kb=", 13) == 0) opt.log.maxFileBytes = uint64_t(std::max(1, atoi(argv[i] + 13))) * 1024;
+        else if (strncmp(argv[i], "--inject-budget-us=", 19) == 0) opt.injectBudgetUs = std::min(100000, std::max(0, atoi(argv[i] + 19)));
+    }
+    std::unique_ptr<redmouse::InputSink> sink = redmouse::makeSink(sinkKind);
+    if (!sink) {
+        printf("Unknown sink: %s\n", sinkKind);
+        return 1;
+    }
+    MouseController controller(std::move(sink), opt);
     controller.run();
     return 0;
 }
@@ -3,12 +3,35 @@
 #define NOMINMAX
 #include <windows.h>
 #include <CommCtrl.h>
-#include <dwmapi.h>
-#include <shellscalingapi.h>
+#include <shellapi.h>
+#include <psapi.h>
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <cmath>
 #include <algorithm>
+#include <memory>
+#include <cwchar>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "core/ActivityPower.h"
+#include "core/ControlPlane.h"
+#include "core/Gate.h"
+#include "core/InjectQueue.h"
+#include "core/InputSink.h"
+#include "core/MotionIntegrator.h"
+#include "core/Presets.h"
+#include "core/Profile.h"
+#include "core/Reactor.h"
+#define REDMOUSE_COUNT_ALLOCATIONS // this TU's operator new counts allocations per thread
+#include "core/RealtimeThread.h"
+#include "core/SessionLog.h"
+#include "core/Settings.h"
+#include "core/Telemetry.h"
+#include "core/TickScheduler.h"
 
 #ifdef min
 #undef min
@@ -17,11 +40,11 @@
 #undef max
 #endif
 
-#pragma comment(lib, "Comctl32.lib")
+// comctl32, dwmapi and shell32 are not linked: lateBind() loads them when the window or tray icon
+// is first needed, so a headless run never maps them.
 #pragma comment(lib, "User32.lib")
-#pragma comment(lib, "Dwmapi.lib")
-#pragma comment(lib, "Shcore.lib")
 #pragma comment(lib, "winmm.lib")
+#pragma comment(lib, "Avrt.lib")
 
 #pragma comment(linker, \
 "\"/manifestdependency:type='win32' \
@@ -33,107 +56,350 @@ static COLORREF kBg   = RGB(28,28,28);
 static COLORREF kText = RGB(232,232,232);
 static COLORREF kGood = RGB(40,200,40);
 static COLORREF kBad  = RGB(220,60,60);
-static HBRUSH   kBgBr = CreateSolidBrush(kBg);
+static HBRUSH   kBgBr = nullptr; // created with the first window, not by a static initializer
+
+// System32 only; the manifest's activation context still redirects comctl32 to v6.
+static FARPROC lateBind(const wchar_t* dll, const char* fn) {
+    HMODULE m = LoadLibraryExW(dll, nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    return m ? GetProcAddress(m, fn) : nullptr;
+}
 
 static BOOL EnableDarkTitleBar(HWND hwnd, BOOL enable) {
     const DWORD DWMWA_USE_IMMERSIVE_DARK_MODE = 20; // Win10 1809+/Win11
-    return DwmSetWindowAttribute(hwnd, DWMWA_USE_IMMERSIVE_DARK_MODE,
-                                 &enable, sizeof(enable)) == S_OK;
+    using SetAttributeFn = HRESULT (WINAPI*)(HWND, DWORD, LPCVOID, DWORD);
+    static const auto setAttribute = reinterpret_cast<SetAttributeFn>(lateBind(L"dwmapi.dll", "DwmSetWindowAttribute"));
+    return setAttribute && setAttribute(hwnd, DWMWA_USE_IMMERSIVE_DARK_MODE,
+                                        &enable, sizeof(enable)) == S_OK;
+}
+
+// Milliseconds since the process was created (cold start, including loader time before wWinMain).
+static double msSinceProcessStart() {
+    FILETIME create, exited, kernel, user, now;
+    if (!GetProcessTimes(GetCurrentProcess(), &create, &exited, &kernel, &user)) return 0.0;
+    GetSystemTimePreciseAsFileTime(&now);
+    const auto ticks = [](const FILETIME& f) { return (int64_t(f.dwHighDateTime) << 32) | f.dwLowDateTime; };
+    return double(ticks(now) - ticks(create)) / 1e4;
+}
+
+// Working set, handle counts and which UI DLLs are mapped: the headless vs windowed footprint.
+static void reportFootprint(const char* what, double ms) {
+    HANDLE self = GetCurrentProcess();
+    PROCESS_MEMORY_COUNTERS pmc{ sizeof(pmc) };
+    GetProcessMemoryInfo(self, &pmc, sizeof(pmc));
+    DWORD handles = 0;
+    GetProcessHandleCount(self, &handles);
+    char line[288];
+    std::snprintf(line, sizeof(line),
+                  "RedMouse: %s in %.1f ms; working set %.1f MB (peak %.1f), %lu handles, %lu GDI / %lu USER objects, comctl32 %s, dwmapi %s\n",
+                  what, ms, pmc.WorkingSetSize / 1048576.0, pmc.PeakWorkingSetSize / 1048576.0, (unsigned long)handles,
+                  (unsigned long)GetGuiResources(self, GR_GDIOBJECTS), (unsigned long)GetGuiResources(self, GR_USEROBJECTS),
+                  GetModuleHandleW(L"comctl32.dll") ? "loaded" : "not loaded",
+                  GetModuleHandleW(L"dwmapi.dll") ? "loaded" : "not loaded");
+    OutputDebugStringA(line);
 }
 
 // -------- App --------
+struct AppOptions {
+    redmouse::TickScheduler<redmouse::SteadyClock>::Config tick; // --rate=, --spin-us=
+    std::wstring telemetryCsv;                                   // --telemetry=<file.csv>
+    std::wstring recordPath;                                     // --record=<file.rms>
+    redmouse::RealtimeOptions realtime;                          // --rt-cpu=<n>, --rt-elevate, --rt-lock, --rt
+    std::string  profilePath;                                    // --profile=<file.rmp>
+    unsigned     uiFps = 60;                                     // --ui-fps=<n> repaint cap
+    bool         fixedPoint = false;                             // --integrator=q32
+    bool         eventEmit = false;                              // --emit=event (implies q32)
+    redmouse::InjectMode inject = redmouse::InjectMode::Direct;  // --inject=batch|coalesce
+    unsigned     injectBudgetUs = 1000;                          // --inject-budget-us=<us>
+    redmouse::PowerPolicy power = redmouse::PowerPolicy::Active; // --power=always|active
+    redmouse::StartPolicy start = redmouse::StartPolicy::Zero;   // --start=zero|immediate|half|carry
+    bool         headless = false;                               // --headless (or a profile's headless flag)
+    bool         tray = false;                                   // --tray = --headless plus a notification-area icon
+    std::string  controlName;                                    // --control[=<name>], empty = off
+};
+
 class StableMouseController {
 private:
-    std::atomic<bool>   enabled{false};
+    // enabled + sensitivity in one versioned snapshot on its own cache line; UI, reactor and
+    // slider publish through it and the motion thread reads it once per tick.
+    redmouse::SettingsCell settings;
     std::atomic<bool>   running{true};
-    std::atomic<double> sensitivity{1.0551};
-
-    std::thread mouseThread, keyboardThread;
-    LARGE_INTEGER qpcFreq{};
+    // F2-F9 table: built-in until a profile loads, swapped whole on hot reload.
+    redmouse::Seqlock<redmouse::PresetTable> presets{ redmouse::PresetTable::builtIn() };
+    redmouse::FileWatcher profileWatcher;
+    std::string profilePath;
+
+    std::unique_ptr<redmouse::InputSink> sink;
+    redmouse::QueuedSink* queue = nullptr; // points into sink under --inject, else null
+    redmouse::Reactor reactor{ [this](const redmouse::InputEvent& e){ onInput(e); } };
+    redmouse::Gate motionGate; // open while enabled && LMB held
+    redmouse::WakeEvent motionWake; // cuts an event-mode sleep short when settings or the gate change
+    std::thread mouseThread;
+    redmouse::TickScheduler<redmouse::SteadyClock>::Config tickConfig;
+    redmouse::Telemetry telemetry;
+    std::wstring telemetryCsv;
+    redmouse::SessionRecorder recorder; // idle unless --record
+    redmouse::ControlPlane control; // idle unless --control: shared-memory mailbox + status for tools/ControlTool
+    std::string controlName;
+    std::wstring recordPath;
+    bool fixedPoint = false;
+    bool eventEmit = false;
+    redmouse::StartPolicy startPolicy = redmouse::StartPolicy::Zero; // accumulator on each press
+    redmouse::RealtimeOptions realtime;
+    redmouse::ActivityPower power; // 1 ms timer period + HIGH_PRIORITY_CLASS, held while motion is active
+    static constexpr int64_t kSelfCheckNs = 250000000;
+    static constexpr int64_t kMaxEventSleepNs = 250000000; // re-check at least 4x/s even when nothing is due
 
     // UI
-    HWND  hMain=nullptr, hStatus=nullptr, hSensText=nullptr, hSlider=nullptr;
+    static constexpr UINT_PTR kTelemetryTimer = 1;
+    static constexpr UINT_PTR kUiTimer        = 2;
+    static constexpr UINT     WM_APP_UI       = WM_APP + 1;
+    static constexpr UINT     WM_APP_TRAY     = WM_APP + 2;
+    static constexpr int      kShowHotkey     = 1; // Ctrl+Alt+R on the host window
+    enum : uint32_t { kDirtyStatus = 1, kDirtySensText = 2, kDirtySlider = 4, kUiPosted = 0x80000000u };
+    std::atomic<HWND> hMain{nullptr}; // null until the window exists (headless: until first opened)
+    HWND  hStatus=nullptr, hSensText=nullptr, hSlider=nullptr, hTelemetry=nullptr; // UI thread only
     HFONT hFont=nullptr;
-
-    void initTimer() {
-        QueryPerformanceFrequency(&qpcFreq);
-        SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
-        timeBeginPeriod(1); // pair with timeEndPeriod(1)
-    }
-
-    static void sendMouseMoveY(int dy) {
+    // Headless: a hidden host window owns the hotkey and tray icon and builds the UI on request.
+    bool      headless = false, tray = false, uiClassReady = false;
+    std::atomic<HWND> hHost{nullptr}; // UI thread writes it; shutdown() reads it from the reactor thread
+    HINSTANCE hInstance = nullptr;
+    UINT      taskbarCreatedMsg = 0; // Explorer restarted: the tray icon must be added again
+    using NotifyIconFn = BOOL (WINAPI*)(DWORD, PNOTIFYICONDATAW);
+    NotifyIconFn notifyIcon = nullptr;
+    std::atomic<uint32_t> uiDirty{0};
+    ULONGLONG uiFrameMs = 16, lastUIFlush = 0;
+    bool   shownEnabled = true;      // forces the first flush to paint
+    double shownSensitivity = -1.0;
+
+    void sendMouseMoveY(int dy) {
         if (dy==0) return;
-        INPUT in{};
-        in.type = INPUT_MOUSE;
-        in.mi.dwFlags = MOUSEEVENTF_MOVE;
-        in.mi.dx = 0;
-        in.mi.dy = dy;
-        SendInput(1, &in, sizeof(INPUT));
+        sink->moveRelative(0, dy);
     }
 
     void mouseProc() {
         SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+        redmouse::RealtimeScope rt(realtime);
+        redmouse::TickScheduler<redmouse::SteadyClock> scheduler(tickConfig);
+        // Startup self-check: what this host actually delivers with the chosen real-time settings.
+        power.raise(); // measured under the same timer period and priority the active loop gets
+        const redmouse::SelfCheckResult check = redmouse::tickSelfCheck(scheduler, kSelfCheckNs);
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "RedMouse: motion thread %s; self-check %llu ticks, jitter p50/p99/max=%.0f/%.0f/%.0fus, missed=%llu, alloc=%llu\n",
+                      rt.describe(), (unsigned long long)check.ticks, check.p50Ns / 1e3, check.p99Ns / 1e3,
+                      check.maxNs / 1e3, (unsigned long long)check.missed, (unsigned long long)check.allocations);
+        OutputDebugStringA(line);
+        if (fixedPoint) runMotion<redmouse::FixedPointIntegrator>(scheduler);
+        else runMotion<redmouse::ClampedDtIntegrator>(scheduler);
+    }
 
-        LARGE_INTEGER last, now;
-        QueryPerformanceCounter(&last);
-
-        double acc = 0.0;
-        constexpr double MAX_ACC = 10.0;
+    // Clock-agnostic so the loop can be driven by a VirtualClock without real time passing.
+    // ClampedDtIntegrator: measured dt clamped to 16 ms, accumulator capped at 10 px.
+    // FixedPointIntegrator: Q32.32, nothing clamped; late ticks pay back the full elapsed time.
+    template <class Integrator, class Clock>
+    void runMotion(redmouse::TickScheduler<Clock>& scheduler) {
+        Integrator integrator;
+        const int64_t startNs = scheduler.clock().nowNs();
+        integrator.start(startNs, startPolicy);
+        recorder.resume(startNs);
+        uint64_t loggedVersion = ~uint64_t(0);
+        const uint64_t allocBase = redmouse::threadAllocations();
 
         while (running.load()) {
-            const bool lDown = (GetAsyncKeyState(VK_LBUTTON) & 0x8000) != 0;
-
-            if (enabled.load() && lDown) {
-                QueryPerformanceCounter(&now);
-                double dt = double(now.QuadPart - last.QuadPart) / qpcFreq.QuadPart;
-                last = now;
-                if (dt > 0.016) dt = 0.016; // frame clamp ~60Hz
-
-                const double pix = sensitivity.load() * 40.0 * dt;
-
-                acc += pix;
-                if (acc > MAX_ACC) acc = MAX_ACC;
-
-                if (acc >= 1.0) {
-                    int py = (int)acc;
-                    sendMouseMoveY(py);
-                    acc -= py;
-                }
-            } else {
-                acc = 0.0;
-                QueryPerformanceCounter(&last);
+            if (!motionGate.isOpen()) {
+                // Parked: no wakeups while idle. Timer period and priority go back after the linger.
+                if (!power.park(motionGate)) break;
+                scheduler.reset();
+                const int64_t now = scheduler.clock().nowNs();
+                integrator.start(now, startPolicy);
+                recorder.resume(now);
             }
-            Sleep(1);
+
+            // Read before the wait: an event-mode sleep is timed for this sensitivity, and a change
+            // that wakes it early takes effect from the next tick.
+            const uint64_t version = settings.version();
+            const redmouse::MotionSettings cfg = settings.load();
+            if (version != loggedVersion) {
+                loggedVersion = version;
+                recorder.settings(scheduler.clock().nowNs(), cfg);
+            }
+            const double sensitivity = cfg.sensitivity;
+            const redmouse::Tick tick = nextTick(scheduler, integrator, sensitivity);
+            const redmouse::StepResult step = integrator.step(sensitivity, tick);
+            recorder.tick(tick, step.dy);
+            redmouse::TickRecord rec{ tick.scheduledNs, tick.actualNs, step.dt, 0.0f, 0, 0, step.flags };
+
+            if (step.dy > 0) {
+                const int64_t injectStart = scheduler.clock().nowNs();
+                sendMouseMoveY(step.dy);
+                rec.injectNs = uint32_t(scheduler.clock().nowNs() - injectStart);
+                rec.dy = step.dy;
+            }
+            rec.acc = float(integrator.accumulator());
+            telemetry.record(rec);
+        }
+        // The loop must never allocate; anything here is a regression worth hearing about.
+        if (const uint64_t n = redmouse::threadAllocations() - allocBase) {
+            char line[96];
+            std::snprintf(line, sizeof(line), "RedMouse: motion loop allocated %llu times\n", (unsigned long long)n);
+            OutputDebugStringA(line);
         }
     }
 
-    void keyboardProc() {
-        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
-        static const double P[8] = {0.8571,1.408,1.15,1.89965,1.72225,12.89035,1.35955,2.29865};
+    // --emit=event: one wakeup per emitted pixel instead of one per tick.
+    template <class Integrator, class Clock>
+    redmouse::Tick nextTick(redmouse::TickScheduler<Clock>& scheduler, Integrator& integrator, double sensitivity) {
+        if constexpr (std::is_same<Integrator, redmouse::FixedPointIntegrator>::value) {
+            if (eventEmit) {
+                const int64_t cap = scheduler.clock().nowNs() + kMaxEventSleepNs;
+                return scheduler.waitUntil(std::min(integrator.nextPixelNs(sensitivity), cap), &motionWake);
+            }
+        }
+        (void)integrator; (void)sensitivity;
+        return scheduler.wait();
+    }
 
-        while (running.load()) {
-            if (GetAsyncKeyState(VK_F1) & 1) { enabled.store(!enabled.load()); updateUI(); }
-            for (int i=0;i<8;++i)
-                if (GetAsyncKeyState(VK_F2+i) & 1) { sensitivity.store(P[i]); updateUI(); }
+    void refreshGate() {
+        motionGate.set(settings.load().enabled && reactor.isDown(redmouse::Key::LButton));
+        motionWake.signal();
+    }
+
+    // Reactor thread: real key/button edges only, no polling.
+    void onInput(const redmouse::InputEvent& e) {
+        using redmouse::Key;
+        recorder.input(e);
 
-            if (GetAsyncKeyState(VK_ADD) & 1)
-                sensitivity.store(std::min(20.0, sensitivity.load()+0.00005)), updateUI();
-            if (GetAsyncKeyState(VK_SUBTRACT) & 1)
-                sensitivity.store(std::max(0.0,  sensitivity.load()-0.00005)), updateUI();
+        if (e.key == Key::LButton) { refreshGate(); return; }
+        if (!e.down) return;
+
+        if (e.key == Key::F1) { toggleEnabled(); }
+        else if (e.key >= Key::F2 && e.key <= Key::F9) { applyPreset(int(e.key)-int(Key::F2)); }
+        else if (e.key == Key::Add)      stepSensitivity(+redmouse::kSensitivityStep);
+        else if (e.key == Key::Subtract) stepSensitivity(-redmouse::kSensitivityStep);
+        else if (e.key == Key::Escape) { shutdown(); }
+    }
 
-            if (GetAsyncKeyState(VK_ESCAPE) & 1) { shutdown(); }
-            Sleep(10);
+    // Writers from any thread; each is one read-modify-write of the snapshot, then a kick so an
+    // event-mode sleep is rescheduled for the new values.
+    template <class Fn>
+    void publish(Fn&& fn) {
+        settings.update(std::forward<Fn>(fn));
+        motionWake.signal();
+    }
+    void toggleEnabled() {
+        publish([](redmouse::MotionSettings& s){ s.enabled = !s.enabled; });
+        refreshGate();
+        requestUI(kDirtyStatus);
+    }
+    void setSensitivity(double v, uint32_t dirty = kDirtySensText | kDirtySlider) {
+        publish([&](redmouse::MotionSettings& s){ s.sensitivity = redmouse::clampSensitivity(v); });
+        requestUI(dirty);
+    }
+    void applyPreset(int index) {
+        const redmouse::PresetTable t = presets.load();
+        if (index < t.count) setSensitivity(t.entries[index].sensitivity);
+    }
+
+    void stepSensitivity(double delta) {
+        publish([&](redmouse::MotionSettings& s){ s.sensitivity = redmouse::clampSensitivity(s.sensitivity + delta); });
+        requestUI(kDirtySensText | kDirtySlider);
+    }
+
+    // Control-plane service thread: same effect as the hotkeys and buttons. false = rejected.
+    bool onControl(const redmouse::ControlCommand& c) {
+        using redmouse::ControlOp;
+        switch (c.op) {
+        case ControlOp::SetEnabled:
+            publish([&](redmouse::MotionSettings& s){ s.enabled = c.arg != 0; });
+            refreshGate();
+            requestUI(kDirtyStatus);
+            return true;
+        case ControlOp::Toggle:
+            toggleEnabled();
+            return true;
+        case ControlOp::SetSensitivity:
+            if (!std::isfinite(c.value)) return false;
+            setSensitivity(c.value);
+            return true;
+        case ControlOp::StepSensitivity:
+            if (!std::isfinite(c.value)) return false;
+            stepSensitivity(c.value);
+            return true;
+        case ControlOp::Preset:
+            if (c.arg < 0 || c.arg >= presets.load().count) return false;
+            applyPreset(c.arg);
+            return true;
+        case ControlOp::Quit:
+            shutdown();
+            return true;
+        default:
+            return false; // SetCurvePattern: V3 has no Curve Pattern
+        }
+    }
+
+    // Startup and watcher thread. A bad file is rejected and the current table stays.
+    // Returns the profile's flags (0 when rejected); only startup acts on them.
+    uint32_t loadProfile() {
+        std::string error;
+        auto p = redmouse::Profile::load(profilePath.c_str(), &error);
+        if (!p) {
+            OutputDebugStringA(("RedMouse: profile rejected: " + error + "\n").c_str());
+            return 0;
+        }
+        presets.store(p->hotkeys());
+        return p->flags();
+    }
+    // -------- UI updates --------
+    // Any thread marks what changed; only the first mark since the last flush posts WM_APP_UI, so a
+    // burst of hotkeys or a slider drag costs one PostMessage. Nothing here waits on the UI thread.
+    // With no window the bits just accumulate; buildUI repaints everything anyway.
+    void requestUI(uint32_t bits) {
+        HWND w = hMain.load(std::memory_order_acquire);
+        if (!w) { uiDirty.fetch_or(bits, std::memory_order_acq_rel); return; }
+        const uint32_t prev = uiDirty.fetch_or(bits | kUiPosted, std::memory_order_acq_rel);
+        if (!(prev & kUiPosted)) PostMessageW(w, WM_APP_UI, 0, 0);
+    }
+
+    // UI thread. Flushes at most once per frame; an early request arms a one-shot timer instead.
+    void onUIRequest() {
+        const ULONGLONG now = GetTickCount64();
+        if (now - lastUIFlush < uiFrameMs) {
+            SetTimer(hMain, kUiTimer, UINT(uiFrameMs - (now - lastUIFlush)), nullptr);
+            return;
+        }
+        flushUI();
+    }
+
+    void flushUI() {
+        KillTimer(hMain, kUiTimer);
+        lastUIFlush = GetTickCount64();
+        const uint32_t bits = uiDirty.exchange(0, std::memory_order_acq_rel);
+        const redmouse::MotionSettings s = settings.load();
+        if ((bits & kDirtyStatus) && s.enabled != shownEnabled) {
+            shownEnabled = s.enabled;
+            SetWindowTextW(hStatus, s.enabled? L"● ACTIVE" : L"○ INACTIVE"); // repaints with the new colour
+        }
+        if ((bits & kDirtySensText) && s.sensitivity != shownSensitivity) {
+            shownSensitivity = s.sensitivity;
+            wchar_t buf[128];
+            swprintf_s(buf, L"Sensitivity: %.7f", s.sensitivity);
+            SetWindowTextW(hSensText, buf);
+        }
+        if ((bits & kDirtySlider) && hSlider) {
+            const LPARAM pos = (LPARAM)(s.sensitivity*100);
+            if (SendMessageW(hSlider, TBM_GETPOS, 0, 0) != pos) // same thread: no cross-thread round-trip
+                SendMessageW(hSlider, TBM_SETPOS, (WPARAM)TRUE, pos);
         }
     }
 
-    void updateUI() {
-        if (!hMain) return;
-        SetWindowTextW(hStatus, enabled.load()? L"● ACTIVE" : L"○ INACTIVE");
+    // UI thread (WM_TIMER): reads the aggregator's snapshot, never the motion thread's state.
+    void updateTelemetryUI() {
+        if (!hTelemetry) return;
+        const redmouse::TelemetrySnapshot s = telemetry.snapshot();
         wchar_t buf[128];
-        swprintf_s(buf, L"Sensitivity: %.7f", sensitivity.load());
-        SetWindowTextW(hSensText, buf);
-        if (hSlider) SendMessageW(hSlider, TBM_SETPOS, (WPARAM)TRUE, (LPARAM)(sensitivity.load()*100));
-        InvalidateRect(hMain, nullptr, FALSE);
+        swprintf_s(buf, L"jitter p50/p99/p99.9 %.0f/%.0f/%.0f µs · inj p99 %.1f µs",
+                   s.jitterP50/1e3, s.jitterP99/1e3, s.jitterP999/1e3, s.injectP99/1e3);
+        SetWindowTextW(hTelemetry, buf);
     }
 
     // ------- helpers for controls (fixed types) -------
@@ -162,7 +428,7 @@ private:
     }
 
     void buildUI(HWND hWnd) {
-        hMain = hWnd;
+        hMain.store(hWnd, std::memory_order_release);
 
         hFont = CreateFontW(18,0,0,0, FW_MEDIUM, FALSE,FALSE,FALSE,
                             DEFAULT_CHARSET, OUT_OUTLINE_PRECIS, CLIP_DEFAULT_PRECIS,
@@ -177,7 +443,7 @@ private:
                                   20, 100, 320-40, 30, hWnd, (HMENU)100,
                                   GetModuleHandleW(nullptr), nullptr);
         SendMessageW(hSlider, TBM_SETRANGE, (WPARAM)TRUE, MAKELPARAM(0,2000));
-        SendMessageW(hSlider, TBM_SETPOS,   (WPARAM)TRUE, (LPARAM)(sensitivity.load()*100));
+        SendMessageW(hSlider, TBM_SETPOS,   (WPARAM)TRUE, (LPARAM)(settings.load().sensitivity*100));
         SendMessageW(hSlider, WM_SETFONT, (WPARAM)hFont, (LPARAM)TRUE);
 
         for (int i=0;i<4;++i){ wchar_t t[8]; swprintf_s(t,L"F%d", i+2); mkButton(2000+i, t, 20+i*72, 140, 64, 32); }
@@ -188,15 +454,136 @@ private:
         mkButton(1010, L"−",           20, 260, 48,  32);
         mkButton(1011, L"+",           76, 260, 48,  32);
         mkStatic(L"Hold Left Click + F1 to activate", 132, 262, 168, 28);
-        mkStatic(L"Made with ❤️ by GodEyeTee",         10, 302, 320-20, 22);
+        hTelemetry = mkStatic(L"jitter —",                    10, 298, 320-20, 22);
+        mkStatic(L"Made with ❤️ by GodEyeTee",         10, 324, 320-20, 22);
 
-        updateUI();
+        SetTimer(hWnd, kTelemetryTimer, 500, nullptr);
+        uiDirty.store(kDirtyStatus | kDirtySensText | kDirtySlider);
+        flushUI();
     }
 
     void shutdown() {
-        enabled.store(false);
+        publish([](redmouse::MotionSettings& s){ s.enabled = false; });
         running.store(false);
-        if (hMain) PostMessageW(hMain, WM_CLOSE, 0, 0);
+        motionGate.release();
+        if (HWND h = hHost.load(std::memory_order_acquire)) PostMessageW(h, WM_CLOSE, 0, 0); // closes the window too, if open
+        else if (HWND w = hMain.load(std::memory_order_acquire)) PostMessageW(w, WM_CLOSE, 0, 0);
+    }
+
+    // -------- Headless host --------
+    // UI thread. The first request registers the class (loading comctl32) and builds the window;
+    // later ones just bring it forward.
+    void showUI() {
+        if (HWND w = hMain) {
+            ShowWindow(w, SW_SHOWNORMAL);
+            SetForegroundWindow(w);
+            return;
+        }
+        const int64_t t0 = redmouse::steadyNowNs();
+        if (!uiClassReady) uiClassReady = registerClass(hInstance);
+        if (uiClassReady && createMain(hInstance))
+            reportFootprint("UI opened", double(redmouse::steadyNowNs() - t0) / 1e6);
+    }
+
+    // WM_DESTROY of the window in headless mode: the controller keeps running without it.
+    void onUIClosed() {
+        hMain.store(nullptr, std::memory_order_release);
+        hStatus = hSensText = hSlider = hTelemetry = nullptr;
+        if (hFont) { DeleteObject(hFont); hFont = nullptr; }
+        shownEnabled = true;
+        shownSensitivity = -1.0;
+    }
+
+    bool addTrayIcon() {
+        if (!notifyIcon) notifyIcon = reinterpret_cast<NotifyIconFn>(lateBind(L"shell32.dll", "Shell_NotifyIconW"));
+        if (!notifyIcon) return false;
+        NOTIFYICONDATAW nid{ sizeof(nid) };
+        nid.hWnd = hHost;
+        nid.uID = 1;
+        nid.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
+        nid.uCallbackMessage = WM_APP_TRAY;
+        nid.hIcon = LoadIconW(nullptr, IDI_APPLICATION);
+        wcscpy_s(nid.szTip, L"RedMouse V3 — click to open");
+        return notifyIcon(NIM_ADD, &nid) != FALSE;
+    }
+
+    void removeTrayIcon() {
+        if (!notifyIcon) return;
+        NOTIFYICONDATAW nid{ sizeof(nid) };
+        nid.hWnd = hHost;
+        nid.uID = 1;
+        notifyIcon(NIM_DELETE, &nid);
+    }
+
+    void trayMenu() {
+        HMENU m = CreatePopupMenu();
+        AppendMenuW(m, MF_STRING, 1, L"Open");
+        AppendMenuW(m, MF_STRING, 2, L"Exit");
+        POINT pt; GetCursorPos(&pt);
+        SetForegroundWindow(hHost); // otherwise the menu stays up after clicking elsewhere
+        const UINT cmd = (UINT)TrackPopupMenu(m, TPM_RETURNCMD | TPM_RIGHTBUTTON, pt.x, pt.y, 0, hHost, nullptr);
+        DestroyMenu(m);
+        if (cmd == 1) showUI();
+        else if (cmd == 2) shutdown();
+    }
+
+    // Hidden top-level window (not HWND_MESSAGE, which misses the TaskbarCreated broadcast); plain user32.
+    bool createHost(HINSTANCE hInst) {
+        WNDCLASSEXW wc{ sizeof(wc) };
+        wc.lpfnWndProc   = HostProc;
+        wc.hInstance     = hInst;
+        wc.lpszClassName = L"RedMouseHost";
+        if (!RegisterClassExW(&wc)) return false;
+        const HWND h = CreateWindowExW(WS_EX_TOOLWINDOW, L"RedMouseHost", L"RedMouse V3", WS_POPUP,
+                                       0, 0, 0, 0, nullptr, nullptr, hInst, this);
+        if (!h) return false;
+        hHost.store(h, std::memory_order_release);
+        if (!RegisterHotKey(h, kShowHotkey, MOD_CONTROL | MOD_ALT | MOD_NOREPEAT, 'R'))
+            OutputDebugStringW(L"RedMouse: Ctrl+Alt+R is taken; open the window from the tray or a second launch\n");
+        if (tray) {
+            taskbarCreatedMsg = RegisterWindowMessageW(L"TaskbarCreated");
+            if (!addTrayIcon()) OutputDebugStringW(L"RedMouse: cannot add tray icon\n");
+        }
+        return true;
+    }
+
+    static LRESULT CALLBACK HostProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        auto* self = reinterpret_cast<StableMouseController*>(GetWindowLongPtrW(hWnd, GWLP_USERDATA));
+        if (msg == WM_NCCREATE) {
+            SetWindowLongPtrW(hWnd, GWLP_USERDATA, (LONG_PTR)reinterpret_cast<CREATESTRUCTW*>(lParam)->lpCreateParams);
+            return (LRESULT)TRUE;
+        }
+        if (!self) return DefWindowProcW(hWnd, msg, wParam, lParam);
+        if (self->taskbarCreatedMsg && msg == self->taskbarCreatedMsg) {
+            self->addTrayIcon();
+            return (LRESULT)0;
+        }
+        switch (msg) {
+        case WM_HOTKEY:
+        case WM_APP_SHOW:
+            self->showUI();
+            return (LRESULT)0;
+
+        case WM_APP_TRAY:
+            switch (LOWORD(lParam)) {
+            case WM_LBUTTONUP: case WM_LBUTTONDBLCLK: self->showUI(); break;
+            case WM_RBUTTONUP: case WM_CONTEXTMENU:   self->trayMenu(); break;
+            }
+            return (LRESULT)0;
+
+        case WM_CLOSE:
+            if (HWND w = self->hMain) DestroyWindow(w);
+            self->removeTrayIcon();
+            UnregisterHotKey(hWnd, kShowHotkey);
+            DestroyWindow(hWnd);
+            return (LRESULT)0;
+
+        case WM_DESTROY:
+            self->hHost.store(nullptr, std::memory_order_release);
+            PostQuitMessage(0);
+            return (LRESULT)0;
+        }
+        return DefWindowProcW(hWnd, msg, wParam, lParam);
     }
 
     // -------- WndProc --------
@@ -223,21 +610,18 @@ private:
         case WM_HSCROLL:
             if ((HWND)lParam == self->hSlider) {
                 int pos = (int)SendMessageW(self->hSlider, TBM_GETPOS, 0, 0);
-                self->sensitivity.store(pos / 100.0);
-                self->updateUI();
+                self->setSensitivity(pos / 100.0, kDirtySensText); // the thumb is already there
             }
             return (LRESULT)0;
 
         case WM_COMMAND: {
             WORD id = LOWORD(wParam);
-            if (id==1001){ self->enabled.store(!self->enabled.load()); self->updateUI(); }
+            if (id==1001){ self->toggleEnabled(); }
             else if (id==1003){ self->shutdown(); }
-            else if (id==1010){ self->sensitivity.store(std::max(0.0,  self->sensitivity.load()-0.00005)); self->updateUI(); }
-            else if (id==1011){ self->sensitivity.store(std::min(20.0, self->sensitivity.load()+0.00005)); self->updateUI(); }
-            else if (id>=2000 && id<=2007){
-                static const double P[8]={0.8571,1.408,1.15,1.89965,1.72225,12.89035,1.35955,2.29865};
-                self->sensitivity.store(P[id-2000]);
-                self->updateUI();
+            else if (id==1010){ self->stepSensitivity(-redmouse::kSensitivityStep); }
+            else if (id==1011){ self->stepSensitivity(+redmouse::kSensitivityStep); }
+            else if (id>=2000 && id<2000+redmouse::kPresetCount){
+                self->applyPreset(id-2000);
             }
             return (LRESULT)0;
         }
@@ -249,40 +633,105 @@ private:
             HDC hdc = (HDC)wParam;
             SetBkColor(hdc, kBg);
             SetTextColor(hdc, (HWND)lParam == self->hStatus
-                               ? (self->enabled.load()? kGood : kBad)
+                               ? (self->shownEnabled? kGood : kBad)
                                : kText);
             return (LRESULT)(INT_PTR)kBgBr; // return HBRUSH
         }
 
+        case WM_APP_UI:
+            self->onUIRequest();
+            return (LRESULT)0;
+
+        case WM_TIMER:
+            if (wParam == kTelemetryTimer) self->updateTelemetryUI();
+            else if (wParam == kUiTimer) self->flushUI();
+            return (LRESULT)0;
+
         case WM_DPICHANGED:
             InvalidateRect(hWnd, nullptr, TRUE);
             return (LRESULT)0;
 
         case WM_CLOSE:
+            KillTimer(hWnd, kTelemetryTimer);
+            KillTimer(hWnd, kUiTimer);
             DestroyWindow(hWnd);
             return (LRESULT)0;
 
         case WM_DESTROY:
-            PostQuitMessage(0);
+            if (self->hHost) self->onUIClosed(); // headless: back to no window
+            else PostQuitMessage(0);
             return (LRESULT)0;
         }
         return DefWindowProcW(hWnd, msg, wParam, lParam);
     }
 
 public:
-    StableMouseController(){ initTimer(); }
+    static constexpr UINT WM_APP_SHOW = WM_APP + 3; // posted to the host by a second launch
+    StableMouseController(std::unique_ptr<redmouse::InputSink> s, const AppOptions& opt)
+        : profilePath(opt.profilePath), sink(std::move(s)), tickConfig(opt.tick), telemetryCsv(opt.telemetryCsv),
+          recordPath(opt.recordPath),
+          fixedPoint(opt.fixedPoint), eventEmit(opt.eventEmit), startPolicy(opt.start),
+          realtime(opt.realtime), power(redmouse::ActivityPower::Options{ opt.power, true, true }), uiFrameMs(1000 / std::max(1u, opt.uiFps)) {
+        headless = opt.headless || opt.tray;
+        controlName = opt.controlName;
+        tray = opt.tray;
+        if (opt.inject != redmouse::InjectMode::Direct) {
+            redmouse::QueuedSink::Options qo;
+            qo.mode = opt.inject;
+            qo.budgetNs = int64_t(opt.injectBudgetUs) * 1000;
+            auto q = std::make_unique<redmouse::QueuedSink>(std::move(sink), qo);
+            queue = q.get();
+            sink = std::move(q);
+        }
+    }
     ~StableMouseController(){
         shutdown();
-        if (mouseThread.joinable())    mouseThread.join();
-        if (keyboardThread.joinable()) keyboardThread.join();
-        timeEndPeriod(1);
+        if (mouseThread.joinable()) mouseThread.join();
+        if (control.active()) {
+            control.stop();
+            char line[96];
+            std::snprintf(line, sizeof(line), "RedMouse: control plane %llu commands, %llu rejected\n",
+                          (unsigned long long)control.applied(), (unsigned long long)control.refused());
+            OutputDebugStringA(line);
+        }
+        profileWatcher.stop();
+        reactor.stop();
+        if (queue) {
+            queue->stop(); // drain what the motion thread left queued
+            const redmouse::InjectorStats q = queue->injectorStats();
+            char line[192];
+            char saved[48] = "";
+            if (q.backendSyscalls) // the mock backend makes no syscalls to save
+                std::snprintf(saved, sizeof(saved), ", %llu syscalls saved", (unsigned long long)q.syscallsSaved);
+            std::snprintf(line, sizeof(line),
+                          "RedMouse: injector %llu moves in %llu batches%s, %llu dropped, delay p99=%.0fus max=%.0fus\n",
+                          (unsigned long long)q.moves, (unsigned long long)q.batches, saved,
+                          (unsigned long long)q.dropped, q.delayP99Ns / 1e3, q.delayMaxNs / 1e3);
+            OutputDebugStringA(line);
+        }
+        recorder.stop();
+        telemetry.stop();
+        power.drop();
+        {
+            const redmouse::PowerStats ps = power.stats();
+            char line[224];
+            std::snprintf(line, sizeof(line),
+                          "RedMouse: power (%s) timer/priority held %.1f%% of %.0f s, %llu activations, parked %.1f%%, ~%llu timer interrupts avoided\n",
+                          redmouse::powerPolicyName(power.options().policy),
+                          ps.totalNs ? 100.0 * double(ps.heldNs) / double(ps.totalNs) : 0.0, ps.totalNs / 1e9,
+                          (unsigned long long)ps.activations, ps.totalNs ? 100.0 * double(ps.parkedNs) / double(ps.totalNs) : 0.0,
+                          (unsigned long long)ps.timerInterruptsAvoided);
+            OutputDebugStringA(line);
+        }
         if (hFont) DeleteObject(hFont);
         if (kBgBr){ DeleteObject(kBgBr); kBgBr=nullptr; }
     }
 
     bool registerClass(HINSTANCE hInst) {
+        using InitControlsFn = BOOL (WINAPI*)(const INITCOMMONCONTROLSEX*);
+        const auto initControls = reinterpret_cast<InitControlsFn>(lateBind(L"comctl32.dll", "InitCommonControlsEx"));
         INITCOMMONCONTROLSEX icc{ sizeof(icc), ICC_BAR_CLASSES | ICC_STANDARD_CLASSES };
-        InitCommonControlsEx(&icc);
+        if (!initControls || !initControls(&icc)) return false; // no trackbar class without it
 
         WNDCLASSEXW wc{ sizeof(wc) };
         wc.lpfnWndProc   = WndProc;
@@ -294,11 +743,11 @@ public:
     }
 
     bool createMain(HINSTANCE hInst) {
-        SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+        if (!kBgBr) kBgBr = CreateSolidBrush(kBg);
         HWND w = CreateWindowExW(WS_EX_APPWINDOW, L"RedMouseStablePlus",
                                  L"RedMouse V3 — Stable+",
                                  WS_OVERLAPPED|WS_CAPTION|WS_SYSMENU|WS_MINIMIZEBOX,
-                                 CW_USEDEFAULT, CW_USEDEFAULT, 320, 360,
+                                 CW_USEDEFAULT, CW_USEDEFAULT, 320, 390,
                                  nullptr, nullptr, hInst, this);
         if (!w) return false;
 
@@ -314,12 +763,45 @@ public:
     }
 
     void run(HINSTANCE hInst) {
-        if (!registerClass(hInst) || !createMain(hInst)) {
+        hInstance = hInst;
+        SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2); // before any window
+        // The profile loads before the window decision: it may ask for headless.
+        if (!profilePath.empty() && (loadProfile() & redmouse::kProfileHeadless)) headless = true;
+        const bool ui = headless ? createHost(hInst) : (uiClassReady = registerClass(hInst)) && createMain(hInst);
+        if (!ui) {
             MessageBoxW(nullptr, L"Initialization failed.", L"Error", MB_ICONERROR|MB_OK);
             return;
         }
-        mouseThread    = std::thread(&StableMouseController::mouseProc,    this);
-        keyboardThread = std::thread(&StableMouseController::keyboardProc, this);
+        if (!reactor.start()) {
+            MessageBoxW(nullptr, L"Failed to install input hooks.", L"Error", MB_ICONERROR|MB_OK);
+            return;
+        }
+        if (!profilePath.empty())
+            profileWatcher.start(profilePath.c_str(), [this]{ loadProfile(); });
+        redmouse::Telemetry::Options topt;
+        if (!telemetryCsv.empty()) topt.csv = _wfopen(telemetryCsv.c_str(), L"w");
+        telemetry.start(std::move(topt));
+        if (!recordPath.empty()) {
+            FILE* f = _wfopen(recordPath.c_str(), L"wb");
+            if (!f || !recorder.start(f, tickConfig.rateHz, fixedPoint ? redmouse::SessionIntegrator::FixedPoint
+                                                                       : redmouse::SessionIntegrator::Clamped,
+                                      eventEmit, redmouse::steadyNowNs(), startPolicy))
+                OutputDebugStringW(L"RedMouse: cannot record session\n");
+        }
+        if (!controlName.empty()) {
+            redmouse::ControlPlane::Options co;
+            co.name = controlName;
+            std::string error;
+            if (!control.start(co, [this](const redmouse::ControlCommand& c){ return onControl(c); },
+                               [this](redmouse::ControlStatus& s){
+                                   s.settings = settings.load();
+                                   s.settingsVersion = settings.version();
+                                   s.telemetry = telemetry.snapshot();
+                               }, &error))
+                OutputDebugStringA(("RedMouse: control plane unavailable: " + error + "\n").c_str());
+        }
+        mouseThread = std::thread(&StableMouseController::mouseProc, this);
+        reportFootprint(headless ? "ready (headless)" : "ready (window)", msSinceProcessStart());
 
         MSG msg{};
         while (GetMessageW(&msg, nullptr, 0, 0)) {
@@ -329,15 +811,124 @@ public:
     }
 };
 
-int WINAPI wWinMain(HINSTANCE hInst, HINSTANCE, PWSTR, int) {
-    HANDLE mx = CreateMutexW(nullptr, TRUE, L"RedMouseV3_StablePlus_Mutex");
+// --sink=sendinput|mock (default: sendinput)
+static std::unique_ptr<redmouse::InputSink> sinkFromCmdLine(PCWSTR cmd) {
+    char kind[32] = "";
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--sink=") : nullptr) {
+        p += 7;
+        size_t n = 0;
+        while (p[n] && p[n] != L' ' && n + 1 < sizeof(kind)) { kind[n] = (char)p[n]; ++n; }
+        kind[n] = 0;
+    }
+    return redmouse::makeSink(kind);
+}
+
+// --rate=<Hz> tick rate 250-8000 (default: 1000), --spin-us=<us> spin tail per tick (default: 50)
+// --telemetry=<file.csv> per-second tick stats, --profile=<file.rmp> presets reloaded on change
+// --ui-fps=<n> cap on window repaints from state changes (default: 60)
+// --integrator=clamped|q32 (default: clamped) q32 = Q32.32 fixed-point against the wall clock
+// --emit=tick|event (default: tick) event = wake only when the next whole pixel is due (implies q32)
+// --record=<file.rms> capture input edges, settings and every tick for tools/SessionReplay
+// --rt-cpu=<n> pin the motion thread, --rt-elevate MMCSS "Pro Audio", --rt-lock lock memory + prefault stack,
+// --rt = --rt-elevate --rt-lock
+// --inject=direct|batch|coalesce (default: direct) queue moves to an injector thread that batches them,
+// --inject-budget-us=<us> longest a queued move may wait for a batch (default: 1000)
+// --power=active|always (default: active) hold the 1 ms timer period and HIGH_PRIORITY_CLASS only while motion is active
+// --start=zero|immediate|half|carry (default: zero) accumulator on each press: empty, one whole pixel (first tick
+// moves), half a pixel (rounds), or the fraction left by the previous hold
+// --control[=<name>] shared-memory mailbox + status block for tools/ControlTool (default name: default)
+// --headless no window at start; Ctrl+Alt+R or launching again opens it. --tray = --headless plus a tray icon
+// True for a bare switch (not a prefix of a longer one).
+static bool hasSwitch(PCWSTR cmd, PCWSTR name) {
+    const size_t n = wcslen(name);
+    for (const wchar_t* p = cmd ? wcsstr(cmd, name) : nullptr; p; p = wcsstr(p + 1, name))
+        if ((p == cmd || p[-1] == L' ') && (p[n] == 0 || p[n] == L' ')) return true;
+    return false;
+}
+
+static AppOptions optionsFromCmdLine(PCWSTR cmd) {
+    AppOptions o;
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--rate=") : nullptr)
+        o.tick.rateHz = (uint32_t)std::min(8000, std::max(250, _wtoi(p + 7)));
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--spin-us=") : nullptr)
+        o.tick.spinNs = (int64_t)std::min(1000, std::max(0, _wtoi(p + 10))) * 1000;
+    if (cmd && wcsstr(cmd, L"--integrator=q32")) o.fixedPoint = true;
+    if (cmd && wcsstr(cmd, L"--emit=event")) o.eventEmit = o.fixedPoint = true;
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--rt-cpu=") : nullptr) o.realtime.cpu = _wtoi(p + 9);
+    if (hasSwitch(cmd, L"--rt-elevate")) o.realtime.elevate = true;
+    if (hasSwitch(cmd, L"--rt-lock")) o.realtime.lockMemory = true;
+    if (hasSwitch(cmd, L"--rt")) o.realtime.elevate = o.realtime.lockMemory = true;
+    if (hasSwitch(cmd, L"--headless")) o.headless = true;
+    if (hasSwitch(cmd, L"--control")) o.controlName = "default";
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--control=") : nullptr) {
+        p += 10;
+        for (; *p && *p != L' '; ++p) o.controlName += (char)*p; // segment names are ASCII
+    }
+    if (hasSwitch(cmd, L"--tray")) o.tray = true;
+    if (cmd && wcsstr(cmd, L"--power=always")) o.power = redmouse::PowerPolicy::Always;
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--start=") : nullptr) {
+        char name[16] = "";
+        p += 8;
+        for (size_t n = 0; p[n] && p[n] != L' ' && n + 1 < sizeof(name); ++n) name[n] = (char)p[n];
+        redmouse::parseStartPolicy(name, o.start);
+    }
+    if (cmd && wcsstr(cmd, L"--inject=batch")) o.inject = redmouse::InjectMode::Batch;
+    if (cmd && wcsstr(cmd, L"--inject=coalesce")) o.inject = redmouse::InjectMode::Coalesce;
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--inject-budget-us=") : nullptr)
+        o.injectBudgetUs = (unsigned)std::min(100000, std::max(0, _wtoi(p + 19)));
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--ui-fps=") : nullptr)
+        o.uiFps = (unsigned)std::min(240, std::max(1, _wtoi(p + 9)));
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--telemetry=") : nullptr) {
+        p += 12;
+        const wchar_t* e = p;
+        while (*e && *e != L' ') ++e;
+        o.telemetryCsv.assign(p, e);
+    }
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--record=") : nullptr) {
+        p += 9;
+        const wchar_t* e = p;
+        while (*e && *e != L' ') ++e;
+        o.recordPath.assign(p, e);
+    }
+    if (const wchar_t* p = cmd ? wcsstr(cmd, L"--profile=") : nullptr) {
+        p += 10;
+        const wchar_t* e = p;
+        while (*e && *e != L' ') ++e;
+        const std::wstring w(p, e);
+        const int n = WideCharToMultiByte(CP_ACP, 0, w.c_str(), int(w.size()), nullptr, 0, nullptr, nullptr);
+        o.profilePath.assign(size_t(n > 0 ? n : 0), '\0');
+        if (n > 0) WideCharToMultiByte(CP_ACP, 0, w.c_str(), int(w.size()), &o.profilePath[0], n, nullptr, nullptr);
+    }
+    return o;
+}
+
+int WINAPI wWinMain(HINSTANCE hInst, HINSTANCE, PWSTR cmdLine, int) {
+    auto sink = sinkFromCmdLine(cmdLine);
+    if (!sink) {
+        MessageBoxW(nullptr, L"Unknown --sink backend.", L"Error", MB_ICONERROR|MB_OK);
+        return 1;
+    }
+    // --instance=<name>: separate single-instance slot, so rigs can run several copies side by side.
+    // (One process driving many pointers is tools/PointerRig + core/ControllerPool.h.)
+    std::wstring mutexName = L"RedMouseV3_StablePlus_Mutex";
+    if (const wchar_t* p = cmdLine ? wcsstr(cmdLine, L"--instance=") : nullptr) {
+        p += 11;
+        const wchar_t* e = p;
+        while (*e && *e != L' ') ++e;
+        mutexName.append(L"_").append(p, e);
+    }
+    HANDLE mx = CreateMutexW(nullptr, TRUE, mutexName.c_str());
     if (GetLastError() == ERROR_ALREADY_EXISTS) {
         HWND w = FindWindowW(L"RedMouseStablePlus", nullptr);
         if (w) SetForegroundWindow(w);
+        else if (HWND host = FindWindowW(L"RedMouseHost", nullptr)) { // headless: ask it to build the window
+            AllowSetForegroundWindow(ASFW_ANY);
+            PostMessageW(host, StableMouseController::WM_APP_SHOW, 0, 0);
+        }
         return 0;
     }
     {
-        StableMouseController app;
+        StableMouseController app(std::move(sink), optionsFromCmdLine(cmdLine));
         app.run(hInst);
     }
     if (mx){ ReleaseMutex(mx); CloseHandle(mx); }
@@ -0,0 +1,121 @@
+// ActivityPower.h — 1 ms timer period and raised process priority, held only while motion is active
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Clock.h"
+#include "Gate.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmsystem.h> // timeBeginPeriod; link winmm.lib
+#endif
+
+namespace redmouse {
+
+enum class PowerPolicy : uint8_t {
+    Always, // hold from start to exit (the old behaviour)
+    Active, // hold while the motion gate is open, plus a short linger after it closes
+};
+
+struct PowerStats {
+    uint64_t activations = 0;
+    int64_t  totalNs  = 0; // since construction
+    int64_t  heldNs   = 0; // timer period / priority held
+    int64_t  parkedNs = 0; // motion thread blocked on the gate
+    uint64_t timerInterruptsAvoided = 0; // estimate, see ActivityPower::kDefaultTimerHz
+};
+
+// Owned by the controller, driven by the motion thread through park(); stats() from any thread.
+// timeBeginPeriod(1) raises the timer interrupt rate for the whole system, which stops the CPU
+// package from reaching deep idle states, so it should not stay set while nobody is moving.
+class ActivityPower {
+public:
+    static constexpr int64_t kDefaultTimerHz = 64; // Windows default 15.625 ms tick
+
+    struct Options {
+        PowerPolicy policy = PowerPolicy::Active;
+        bool timerPeriod  = true;  // timeBeginPeriod(1)
+        bool highPriority = false; // HIGH_PRIORITY_CLASS
+        int64_t lingerNs  = 500000000; // quick re-presses don't toggle the system timer
+    };
+
+    explicit ActivityPower(const Options& o) : opts(o), startNs(steadyNowNs()) {
+        if (opts.policy == PowerPolicy::Always) raise();
+    }
+    ~ActivityPower() { drop(); }
+    ActivityPower(const ActivityPower&) = delete;
+    ActivityPower& operator=(const ActivityPower&) = delete;
+
+    // Motion thread, when the gate is closed. Keeps the resources for lingerNs, then drops them
+    // and blocks until the gate opens; raises them again before returning. False on shutdown.
+    bool park(Gate& gate) {
+        const int64_t t0 = steadyNowNs();
+        GateWait r = GateWait::Timeout;
+        if (opts.policy == PowerPolicy::Always)
+            r = gate.wait() ? GateWait::Open : GateWait::Released;
+        else if (held.load(std::memory_order_relaxed))
+            r = gate.waitFor(std::chrono::nanoseconds(opts.lingerNs));
+        if (r == GateWait::Timeout) {
+            drop();
+            r = gate.wait() ? GateWait::Open : GateWait::Released;
+        }
+        parked.fetch_add(steadyNowNs() - t0, std::memory_order_relaxed);
+        if (r == GateWait::Released) return false;
+        raise();
+        return true;
+    }
+
+    // Motion thread, when it starts out active (gate already open).
+    void raise() {
+        if (held.load(std::memory_order_relaxed)) return;
+#ifdef _WIN32
+        if (opts.timerPeriod) timeBeginPeriod(1);
+        if (opts.highPriority) SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+#endif
+        heldSince.store(steadyNowNs(), std::memory_order_relaxed);
+        activations.fetch_add(1, std::memory_order_relaxed);
+        held.store(true, std::memory_order_release);
+    }
+
+    void drop() {
+        if (!held.load(std::memory_order_relaxed)) return;
+#ifdef _WIN32
+        if (opts.timerPeriod) timeEndPeriod(1);
+        if (opts.highPriority) SetPriorityClass(GetCurrentProcess(), NORMAL_PRIORITY_CLASS);
+#endif
+        heldTotal.fetch_add(steadyNowNs() - heldSince.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        held.store(false, std::memory_order_release);
+    }
+
+    PowerStats stats() const {
+        PowerStats s;
+        const int64_t now = steadyNowNs();
+        s.activations = activations.load(std::memory_order_relaxed);
+        s.totalNs = now - startNs;
+        s.heldNs = heldTotal.load(std::memory_order_relaxed);
+        if (held.load(std::memory_order_acquire)) s.heldNs += now - heldSince.load(std::memory_order_relaxed);
+        s.parkedNs = parked.load(std::memory_order_relaxed);
+        if (opts.timerPeriod && s.totalNs > s.heldNs)
+            s.timerInterruptsAvoided = uint64_t((s.totalNs - s.heldNs) / 1000000) * uint64_t(1000 - kDefaultTimerHz) / 1000;
+        return s;
+    }
+
+    const Options& options() const { return opts; }
+
+private:
+    Options opts;
+    const int64_t startNs;
+    std::atomic<bool> held{false};
+    std::atomic<int64_t> heldSince{0}, heldTotal{0}, parked{0};
+    std::atomic<uint64_t> activations{0};
+};
+
+inline const char* powerPolicyName(PowerPolicy p) { return p == PowerPolicy::Always ? "always" : "active"; }
+
+} // namespace redmouse
@@ -0,0 +1,227 @@
+// Clock.h — real (hybrid sleep/spin) and virtual clocks for the tick scheduler
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <time.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define REDMOUSE_CPU_RELAX() _mm_pause()
+#define REDMOUSE_HAS_TSC 1
+#else
+#define REDMOUSE_CPU_RELAX() ((void)0)
+#endif
+
+namespace redmouse {
+
+inline int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Cheapest monotonic timestamp for hot paths that only need ordering plus a later conversion:
+// the invariant TSC on x86 (a few ns, no vDSO/QPC call), steadyNowNs() elsewhere. Units are
+// ticks; callers convert against a (ticks, steadyNowNs) pair taken at both ends of an interval.
+inline int64_t cpuTicks() {
+#ifdef REDMOUSE_HAS_TSC
+    return int64_t(__rdtsc());
+#else
+    return steadyNowNs();
+#endif
+}
+
+// Cuts a sleep short from another thread (settings change, button release). signal() only
+// touches the kernel object on the first signal since the sleeper last cleared it.
+class WakeEvent {
+public:
+    WakeEvent() {
+#ifdef _WIN32
+        ev = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#elif defined(__linux__)
+        fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+    ~WakeEvent() {
+#ifdef _WIN32
+        if (ev) CloseHandle(ev);
+#elif defined(__linux__)
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+    WakeEvent(const WakeEvent&) = delete;
+    WakeEvent& operator=(const WakeEvent&) = delete;
+
+    void signal() {
+        if (flag.exchange(true, std::memory_order_acq_rel)) return;
+#ifdef _WIN32
+        if (ev) SetEvent(ev);
+#elif defined(__linux__)
+        const uint64_t one = 1;
+        if (fd >= 0) (void)!::write(fd, &one, sizeof(one));
+#endif
+    }
+
+    bool isSet() const { return flag.load(std::memory_order_acquire); }
+
+    // Blocks with no timeout until signal(); returns at once if already signalled.
+    void wait() const {
+        while (!isSet()) {
+#ifdef _WIN32
+            if (ev) { WaitForSingleObject(ev, INFINITE); continue; }
+#elif defined(__linux__)
+            if (fd >= 0) { pollfd pfd{ fd, POLLIN, 0 }; ::poll(&pfd, 1, -1); continue; }
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // no kernel object to block on
+        }
+    }
+
+    // Sleeper side. Kernel object first, flag second: a racing signal() can only cause one
+    // spurious wake-up, never a lost one.
+    void clear() {
+#ifdef _WIN32
+        if (ev) ResetEvent(ev);
+#elif defined(__linux__)
+        uint64_t n;
+        if (fd >= 0) (void)!::read(fd, &n, sizeof(n));
+#endif
+        flag.store(false, std::memory_order_release);
+    }
+
+#ifdef _WIN32
+    HANDLE handle() const { return ev; }
+#elif defined(__linux__)
+    int handle() const { return fd; }
+#endif
+
+private:
+    std::atomic<bool> flag{false};
+#ifdef _WIN32
+    HANDLE ev = nullptr;
+#elif defined(__linux__)
+    int fd = -1;
+#endif
+};
+
+// Any clock passed to TickScheduler provides nowNs() and sleepUntil(deadlineNs, spinNs).
+// Event-scheduled waits (TickScheduler::waitUntil) also need sleepUntil(deadlineNs, spinNs, WakeEvent*),
+// which returns false when the wake event cut the sleep short.
+
+// Sleeps on the OS high-resolution timer until spinNs before the deadline, then spins the rest.
+class SteadyClock {
+public:
+    SteadyClock() {
+#ifdef _WIN32
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+        // High-resolution timers need Win10 1803+; older systems fall back to a classic timer.
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer) timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+#endif
+    }
+    ~SteadyClock() {
+#ifdef _WIN32
+        if (timer) CloseHandle(timer);
+#endif
+    }
+    SteadyClock(const SteadyClock&) = delete;
+    SteadyClock& operator=(const SteadyClock&) = delete;
+
+    int64_t nowNs() const { return steadyNowNs(); }
+
+    void sleepUntil(int64_t deadlineNs, int64_t spinNs) { sleepUntil(deadlineNs, spinNs, nullptr); }
+
+    bool sleepUntil(int64_t deadlineNs, int64_t spinNs, const WakeEvent* wake) {
+        if (wake && wake->isSet()) return false;
+        const int64_t coarse = deadlineNs - spinNs;
+        const int64_t now = nowNs();
+        if (coarse > now) {
+#ifdef _WIN32
+            LARGE_INTEGER due;
+            due.QuadPart = -((coarse - now) / 100); // relative, 100 ns units
+            const HANDLE hs[2] = { timer, wake ? wake->handle() : nullptr };
+            const DWORD n = (wake && hs[1]) ? 2 : 1;
+            if (!timer || due.QuadPart >= 0 ||
+                !SetWaitableTimerEx(timer, &due, 0, nullptr, nullptr, nullptr, 0)) {
+                Sleep(DWORD((coarse - now) / 1000000));
+            } else {
+                const DWORD r = WaitForMultipleObjects(n, hs, FALSE, INFINITE);
+                if (r == WAIT_OBJECT_0 + 1) { CancelWaitableTimer(timer); return false; }
+                if (r != WAIT_OBJECT_0) Sleep(DWORD((coarse - now) / 1000000));
+            }
+#else
+#ifdef __linux__
+            if (wake && wake->handle() >= 0) {
+                // ppoll is hrtimer-backed too; the eventfd makes the sleep interruptible.
+                const int64_t rel = coarse - now;
+                timespec ts{ time_t(rel / 1000000000), long(rel % 1000000000) };
+                pollfd pfd{ wake->handle(), POLLIN, 0 };
+                if (ppoll(&pfd, 1, &ts, nullptr) > 0) return false;
+            } else
+#endif
+            {
+                timespec ts;
+                ts.tv_sec  = time_t(coarse / 1000000000);
+                ts.tv_nsec = long(coarse % 1000000000);
+                // steady_clock is CLOCK_MONOTONIC on Linux, so absolute deadlines line up.
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+            }
+#endif
+        }
+        while (nowNs() < deadlineNs) {
+            if (wake && wake->isSet()) return false;
+            REDMOUSE_CPU_RELAX();
+        }
+        return true;
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE timer = nullptr;
+#endif
+};
+
+// Deterministic time for simulations: sleeping just jumps to the deadline.
+class VirtualClock {
+public:
+    explicit VirtualClock(int64_t startNs = 0) : t(startNs) {}
+
+    int64_t nowNs() const { return t; }
+    void sleepUntil(int64_t deadlineNs, int64_t) { if (deadlineNs > t) t = deadlineNs; }
+    bool sleepUntil(int64_t deadlineNs, int64_t spinNs, const WakeEvent* wake) {
+        if (wake && wake->isSet()) return false;
+        sleepUntil(deadlineNs, spinNs);
+        return true;
+    }
+
+    // Models time spent doing work (or a scheduler hiccup) between waits.
+    void advance(int64_t ns) { t += ns; }
+    void set(int64_t ns) { t = ns; }
+
+private:
+    int64_t t;
+};
+
+} // namespace redmouse
@@ -0,0 +1,425 @@
+// ControlPlane.h — shared-memory command mailbox and live status block for external tools
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Clock.h"
+#include "Settings.h"
+#include "Telemetry.h"
+
+namespace redmouse {
+
+// One named segment per controller: "Local\RedMouseControl-<name>" on Windows (per session),
+// "/redmouse-control-<name>" under /dev/shm on Linux. Clients reach it with plain loads, stores
+// and CAS; the only syscalls are opening and mapping it. The owner polls the mailbox on its own
+// thread, so nothing here sends window messages or touches the motion thread.
+//
+// Both sides must be built from the same header: version and size are checked on open.
+inline constexpr uint32_t kControlMagic   = 0x4C43524Du; // "MRCL"
+inline constexpr uint32_t kControlVersion = 1;
+inline constexpr uint32_t kControlSlots   = 64;          // mailbox capacity, power of two
+
+enum class ControlOp : uint32_t {
+    Nop,
+    SetEnabled,       // arg: 0/1
+    Toggle,
+    SetSensitivity,   // value
+    StepSensitivity,  // value (signed)
+    Preset,           // arg: F2-F9 table index
+    SetCurvePattern,  // arg: 0/1 (MouseRed only)
+    Quit,
+};
+
+inline const char* controlOpName(ControlOp op) {
+    static const char* const names[] = { "nop", "enable", "toggle", "sensitivity", "step", "preset", "curve", "quit" };
+    return unsigned(op) <= unsigned(ControlOp::Quit) ? names[unsigned(op)] : "?";
+}
+
+struct ControlCommand {
+    ControlOp op    = ControlOp::Nop;
+    int32_t   arg   = 0;
+    double    value = 0.0;
+};
+
+// Published by the owner, copied out whole by clients (Seqlock in the segment).
+struct ControlStatus {
+    MotionSettings    settings;
+    uint64_t          settingsVersion = 0;
+    uint64_t          commands = 0;   // applied since start
+    uint64_t          rejected = 0;   // refused by the controller (bad index, unsupported op, non-finite value)
+    int64_t           updatedNs = 0;  // owner's steadyNowNs(); the clock is system-wide
+    TelemetrySnapshot telemetry;
+};
+
+// The shared layout. Plain data and lock-free atomics only, so it works across processes.
+struct ControlSegment {
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq;    // == position: free for that enqueue; == position + 1: full
+        ControlCommand        cmd;
+    };
+
+    std::atomic<uint32_t> magic{0};   // stored last, once everything else is initialised
+    uint32_t              version = kControlVersion;
+    uint32_t              size    = uint32_t(sizeof(ControlSegment));
+    uint32_t              slots   = kControlSlots;
+    std::atomic<uint64_t> ownerPid{0};  // 0 once the owner has stopped
+    std::atomic<int64_t>  heartbeatNs{0};
+    alignas(64) std::atomic<uint64_t> enqueuePos{0}; // clients
+    alignas(64) std::atomic<uint64_t> dequeuePos{0}; // owner only
+    std::atomic<uint64_t> appliedPos{0};             // tickets up to here have been handled
+    Slot                  slot[kControlSlots];
+    Seqlock<ControlStatus> status;
+
+    ControlSegment() {
+        for (uint32_t i = 0; i < kControlSlots; ++i) slot[i].seq.store(i, std::memory_order_relaxed);
+    }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+static_assert((kControlSlots & (kControlSlots - 1)) == 0, "kControlSlots must be a power of two");
+
+namespace detail {
+
+inline bool processAlive(uint64_t pid) {
+    if (!pid) return false;
+#ifdef _WIN32
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(pid));
+    if (!h) return GetLastError() == ERROR_ACCESS_DENIED;
+    DWORD code = 0;
+    const bool alive = GetExitCodeProcess(h, &code) && code == STILL_ACTIVE;
+    CloseHandle(h);
+    return alive;
+#elif defined(__linux__)
+    return kill(pid_t(pid), 0) == 0 || errno == EPERM;
+#else
+    return false;
+#endif
+}
+
+inline uint64_t currentPid() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#elif defined(__linux__)
+    return uint64_t(getpid());
+#else
+    return 1;
+#endif
+}
+
+// A named, writable shared mapping of one ControlSegment.
+class SharedSegment {
+public:
+    SharedSegment() = default;
+    ~SharedSegment() { close(); }
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    // create: make it if missing. existed tells the caller whether someone else made it first.
+    bool map(const std::string& name, bool create, bool& existed, std::string* error) {
+        close();
+        existed = false;
+#ifdef _WIN32
+        const std::string full = "Local\\RedMouseControl-" + name;
+        if (create) {
+            handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                        DWORD(sizeof(ControlSegment)), full.c_str());
+            existed = handle && GetLastError() == ERROR_ALREADY_EXISTS;
+        } else {
+            handle = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, full.c_str());
+        }
+        if (!handle) return fail(error, create ? "cannot create " : "no controller at ", full);
+        base = MapViewOfFile(handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(ControlSegment));
+        if (!base) return fail(error, "cannot map (older or newer layout?) ", full);
+#elif defined(__linux__)
+        shmName = "/redmouse-control-" + name;
+        int fd = create ? shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600) : -1;
+        if (create && fd < 0 && errno == EEXIST) existed = true;
+        if (fd < 0) fd = shm_open(shmName.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) return fail(error, create ? "cannot create " : "no controller at /dev/shm", shmName);
+        struct stat st{};
+        bool ok = true;
+        if (create && !existed) ok = ftruncate(fd, off_t(sizeof(ControlSegment))) == 0;
+        else ok = fstat(fd, &st) == 0 && size_t(st.st_size) == sizeof(ControlSegment);
+        if (ok) {
+            void* p = mmap(nullptr, sizeof(ControlSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) base = p;
+        }
+        ::close(fd);
+        if (!base) return fail(error, ok ? "cannot map " : "size mismatch (older or newer layout?) ", shmName);
+#else
+        (void)name; (void)create;
+        return fail(error, "shared memory not supported on this platform", "");
+#endif
+        return true;
+    }
+
+    // Owner only: removes the name so the next owner starts from a fresh segment.
+    void unlink() {
+#if defined(__linux__)
+        if (!shmName.empty()) shm_unlink(shmName.c_str());
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (handle) CloseHandle(handle);
+        handle = nullptr;
+#elif defined(__linux__)
+        if (base) munmap(base, sizeof(ControlSegment));
+#endif
+        base = nullptr;
+    }
+
+    ControlSegment* get() const { return static_cast<ControlSegment*>(base); }
+
+private:
+    void* base = nullptr;
+#ifdef _WIN32
+    HANDLE handle = nullptr;
+#elif defined(__linux__)
+    std::string shmName;
+#endif
+
+    bool fail(std::string* error, const char* what, const std::string& name) {
+        if (error) *error = what + name;
+        close();
+        return false;
+    }
+};
+
+} // namespace detail
+
+// Owner side, one per controller. A service thread drains the mailbox and republishes the
+// status block; it polls every pollMinUs right after a command and doubles the wait on every empty
+// poll up to pollMaxUs, so an idle controller wakes about four times per second and a command sent
+// to it waits at most 250 ms (a burst of commands only pays that once). pollMaxUs = 0 spins with
+// yields (benchmarks; it keeps a core busy).
+class ControlPlane {
+public:
+    struct Options {
+        std::string name = "default";
+        uint32_t pollMinUs = 1000;
+        uint32_t pollMaxUs = 250000;
+        uint32_t statusIntervalMs = 250; // heartbeat while idle; no point refreshing between polls
+    };
+    // Runs on the service thread. false = rejected (counted, not retried).
+    using Apply = std::function<bool(const ControlCommand&)>;
+    using Fill  = std::function<void(ControlStatus&)>;
+
+    ControlPlane() = default;
+    ~ControlPlane() { stop(); }
+    ControlPlane(const ControlPlane&) = delete;
+    ControlPlane& operator=(const ControlPlane&) = delete;
+
+    bool start(const Options& o, Apply apply, Fill fill, std::string* error = nullptr) {
+        if (worker.joinable()) return true;
+        bool existed = false;
+        if (!mapping.map(o.name, true, existed, error)) return false;
+        ControlSegment* seg = mapping.get();
+        if (existed) {
+            // Left behind by a controller that crashed, or held open by a client: reuse it
+            // unless its owner is still running.
+            const uint64_t pid = seg->magic.load(std::memory_order_acquire) == kControlMagic
+                                     ? seg->ownerPid.load(std::memory_order_relaxed) : 0;
+            if (detail::processAlive(pid) && pid != detail::currentPid()) {
+                if (error) *error = "control segment '" + o.name + "' is owned by pid " + std::to_string(pid);
+                mapping.close();
+                return false;
+            }
+            seg->magic.store(0, std::memory_order_release);
+        }
+        new (seg) ControlSegment();
+        seg->ownerPid.store(detail::currentPid(), std::memory_order_relaxed);
+        seg->magic.store(kControlMagic, std::memory_order_release);
+
+        opts = o;
+        applyFn = std::move(apply);
+        fillFn = std::move(fill);
+        commands.store(0, std::memory_order_relaxed);
+        rejected.store(0, std::memory_order_relaxed);
+        stopping.store(false, std::memory_order_relaxed);
+        publishStatus(steadyNowNs());
+        worker = std::thread(&ControlPlane::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lk(mx);
+            stopping.store(true, std::memory_order_relaxed);
+        }
+        cv.notify_all();
+        worker.join();
+        ControlSegment* seg = mapping.get();
+        publishStatus(steadyNowNs());
+        seg->ownerPid.store(0, std::memory_order_relaxed);
+        seg->heartbeatNs.store(0, std::memory_order_release);
+        mapping.unlink();
+        mapping.close();
+    }
+
+    bool active() const { return worker.joinable(); }
+    uint64_t applied() const { return commands.load(std::memory_order_relaxed); }
+    uint64_t refused() const { return rejected.load(std::memory_order_relaxed); }
+
+private:
+    detail::SharedSegment mapping;
+    Options opts;
+    Apply applyFn;
+    Fill fillFn;
+    std::thread worker;
+    std::mutex mx;
+    std::condition_variable cv;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> commands{0}, rejected{0}; // written by the service thread only
+
+    size_t drain() {
+        ControlSegment* seg = mapping.get();
+        size_t n = 0;
+        for (uint64_t pos = seg->dequeuePos.load(std::memory_order_relaxed);; ++pos) {
+            ControlSegment::Slot& s = seg->slot[pos & (kControlSlots - 1)];
+            if (s.seq.load(std::memory_order_acquire) != pos + 1) break;
+            const ControlCommand cmd = s.cmd;
+            s.seq.store(pos + kControlSlots, std::memory_order_release); // slot free for the next lap
+            seg->dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            if (cmd.op != ControlOp::Nop && (!applyFn || !applyFn(cmd))) rejected.fetch_add(1, std::memory_order_relaxed);
+            else commands.fetch_add(1, std::memory_order_relaxed);
+            seg->appliedPos.store(pos + 1, std::memory_order_release);
+            ++n;
+        }
+        return n;
+    }
+
+    void publishStatus(int64_t now) {
+        ControlStatus st;
+        if (fillFn) fillFn(st);
+        st.commands = applied();
+        st.rejected = refused();
+        st.updatedNs = now;
+        ControlSegment* seg = mapping.get();
+        seg->status.store(st);
+        seg->heartbeatNs.store(now, std::memory_order_release);
+    }
+
+    void run() {
+        const int64_t statusNs = int64_t(opts.statusIntervalMs) * 1000000;
+        int64_t nextStatus = steadyNowNs() + statusNs;
+        uint32_t waitUs = opts.pollMinUs;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            const size_t n = drain();
+            const int64_t now = steadyNowNs();
+            if (n || now >= nextStatus) {
+                publishStatus(now);
+                nextStatus = now + statusNs;
+            }
+            if (opts.pollMaxUs == 0) { // spin, but let clients on the same core run
+                if (!n) std::this_thread::yield();
+                continue;
+            }
+            waitUs = n ? opts.pollMinUs : std::min(opts.pollMaxUs, std::max(1u, waitUs) * 2);
+            std::unique_lock<std::mutex> lk(mx);
+            cv.wait_for(lk, std::chrono::microseconds(waitUs),
+                        [&] { return stopping.load(std::memory_order_relaxed); });
+        }
+        drain(); // what was queued before stop() still counts
+    }
+};
+
+// Client side: any process, any number of threads. send() is a lock-free multi-producer push.
+class ControlClient {
+public:
+    bool open(const std::string& name = "default", std::string* error = nullptr) {
+        bool existed = false;
+        if (!mapping.map(name, false, existed, error)) return false;
+        const ControlSegment* seg = mapping.get();
+        if (seg->magic.load(std::memory_order_acquire) != kControlMagic || seg->version != kControlVersion ||
+            seg->size != sizeof(ControlSegment) || seg->slots != kControlSlots) {
+            if (error) *error = "control segment '" + name + "' has another version or is not initialised";
+            mapping.close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() { mapping.close(); }
+    bool ok() const { return mapping.get() != nullptr; }
+
+    // Ticket for applied(), or 0 when the mailbox is full (the owner is stalled or gone).
+    uint64_t send(const ControlCommand& cmd) {
+        ControlSegment* seg = mapping.get();
+        uint64_t pos = seg->enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            ControlSegment::Slot& s = seg->slot[pos & (kControlSlots - 1)];
+            const int64_t d = int64_t(s.seq.load(std::memory_order_acquire) - pos);
+            if (d == 0) {
+                if (seg->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    s.cmd = cmd;
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return pos + 1;
+                }
+            } else if (d < 0) {
+                return 0;
+            } else {
+                pos = seg->enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool applied(uint64_t ticket) const {
+        return mapping.get()->appliedPos.load(std::memory_order_acquire) >= ticket;
+    }
+
+    // Spins, then yields, until the owner has handled the ticket or timeoutNs passes.
+    bool wait(uint64_t ticket, int64_t timeoutNs) const {
+        const int64_t deadline = steadyNowNs() + timeoutNs;
+        for (unsigned i = 0; !applied(ticket); ++i) {
+            if (i < 64) { REDMOUSE_CPU_RELAX(); continue; }
+            if (steadyNowNs() > deadline) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    ControlStatus status() const { return mapping.get()->status.load(); }
+
+    // Owner still running and publishing (it republishes at least every statusIntervalMs).
+    bool ownerAlive(int64_t staleNs = 1000000000) const {
+        const ControlSegment* seg = mapping.get();
+        const int64_t beat = seg->heartbeatNs.load(std::memory_order_acquire);
+        return beat && steadyNowNs() - beat < staleNs &&
+               detail::processAlive(seg->ownerPid.load(std::memory_order_relaxed));
+    }
+
+    uint64_t ownerPid() const { return mapping.get()->ownerPid.load(std::memory_order_relaxed); }
+
+private:
+    detail::SharedSegment mapping;
+};
+
+} // namespace redmouse
@@ -0,0 +1,355 @@
+// ControllerPool.h — many independent virtual pointers on one timer wheel and a small worker pool
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Clock.h"
+#include "InputSink.h"
+#include "MotionIntegrator.h"
+#include "Settings.h"
+#include "SpscRing.h"
+#include "Telemetry.h"
+#include "TimerWheel.h"
+#include "Trajectory.h"
+
+namespace redmouse {
+
+struct PoolStats {
+    uint64_t streams = 0, workers = 0;
+    uint64_t services = 0;          // stream wake-ups handled by the workers
+    uint64_t moves = 0, pixels = 0; // summed over every stream's sink
+    uint64_t schedulerWakeups = 0;
+    uint64_t lateP50Ns = 0, lateP99Ns = 0, lateMaxNs = 0; // deadline -> worker picked the stream up
+};
+
+// Each stream is one controller: its own SettingsCell, sink, Q32.32 integrator and curve player.
+// A stream moves while settings.enabled is set (the rig's "button held"). Straight motion is
+// event-scheduled (one wake-up per whole pixel, like --emit=event); Curve Pattern runs on a
+// kCurveRateHz grid. A scheduler thread owns the timer wheel and hands due streams to a fixed
+// worker (id % workers), so each sink keeps a single producer and a stream never runs twice at
+// once. Workers hand the next deadline back through a ring; nothing on that path locks.
+class ControllerPool {
+public:
+    static constexpr int64_t  kCurveStrokeNs = 10000000;
+    static constexpr uint32_t kCurveRateHz   = 1000;
+    static constexpr int64_t  kMaxSleepNs    = 250000000; // re-check parked-velocity streams 4x/s
+
+    struct Options {
+        unsigned workers = 0;      // 0 = one per hardware thread, minus the scheduler's
+        int64_t  slotNs  = 250000; // timer-wheel resolution; deadlines are still kept exactly
+        size_t   slots   = 1024;
+        int64_t  spinNs  = 0;      // scheduler busy-wait tail before each deadline
+    };
+
+    ControllerPool() : ControllerPool(Options{}) {}
+    explicit ControllerPool(const Options& o) : opts(o), builtInCurve(Trajectory::legacyBob()) {
+        if (!opts.workers) {
+            const unsigned hw = std::thread::hardware_concurrency();
+            opts.workers = hw > 1 ? hw - 1 : 1;
+        }
+    }
+    ~ControllerPool() { stop(); }
+    ControllerPool(const ControllerPool&) = delete;
+    ControllerPool& operator=(const ControllerPool&) = delete;
+
+    // Setup, before start(). A curve's index is what MotionSettings::curve selects; -1 = built-in.
+    int addCurve(Trajectory shape, int64_t strokeNs) {
+        curves.push_back(CurveDef{ std::move(shape), strokeNs });
+        return int(curves.size() - 1);
+    }
+    uint32_t add(std::unique_ptr<InputSink> sink, const MotionSettings& initial = MotionSettings{}) {
+        streams.push_back(std::make_unique<Stream>(std::move(sink), &builtInCurve, initial));
+        return uint32_t(streams.size() - 1);
+    }
+
+    void start() {
+        if (scheduler.joinable() || streams.empty()) return;
+        const size_t n = streams.size();
+        wheel = std::make_unique<TimerWheel>(n, opts.slotNs, opts.slots, steadyNowNs());
+        where.assign(n, Parked);
+        kicked.assign(n, 0);
+        kickedAtWorker = 0;
+        for (unsigned i = 0; i < opts.workers; ++i) workers.push_back(std::make_unique<Worker>(n));
+        stopping.store(false, std::memory_order_release);
+        for (uint32_t id = 0; id < n; ++id) kick(id); // streams created enabled start at once
+        for (unsigned i = 0; i < opts.workers; ++i) workers[i]->thread = std::thread(&ControllerPool::work, this, i);
+        scheduler = std::thread(&ControllerPool::schedule, this);
+    }
+
+    void stop() {
+        if (!scheduler.joinable()) return;
+        stopping.store(true, std::memory_order_release);
+        wake.signal();
+        scheduler.join();
+        for (auto& w : workers) { w->wake.signal(); w->thread.join(); }
+    }
+
+    // Any thread. Publishes a settings change and makes the stream re-plan right away.
+    template <class Fn>
+    MotionSettings update(uint32_t id, Fn&& fn) {
+        const MotionSettings s = streams[id]->settings.update(std::forward<Fn>(fn));
+        kick(id);
+        return s;
+    }
+    void press(uint32_t id)   { update(id, [](MotionSettings& s) { s.enabled = true; }); }
+    void release(uint32_t id) { update(id, [](MotionSettings& s) { s.enabled = false; }); }
+
+    size_t size() const { return streams.size(); }
+    const InputSink& sink(uint32_t id) const { return *streams[id]->sink; }
+
+    PoolStats stats() const {
+        PoolStats p;
+        p.streams = streams.size();
+        p.workers = workers.size();
+        p.schedulerWakeups = schedulerWakeups.load(std::memory_order_relaxed);
+        LogHistogram late;
+        for (const auto& w : workers) {
+            std::lock_guard<std::mutex> lk(w->mx);
+            p.services += w->services;
+            late.merge(w->late);
+        }
+        for (const auto& s : streams) {
+            const SinkStats k = s->sink->stats();
+            p.moves += k.calls;
+            p.pixels += k.pixels;
+        }
+        p.lateP50Ns = late.percentile(0.50);
+        p.lateP99Ns = late.percentile(0.99);
+        p.lateMaxNs = late.maxValue();
+        return p;
+    }
+
+private:
+    static constexpr int64_t kParkedNs = INT64_MAX;
+    static constexpr int64_t kIdleNs   = 100000000;
+    static constexpr size_t  kBatch    = 64;
+    enum Where : uint8_t { Parked, InWheel, AtWorker };
+
+    struct CurveDef {
+        Trajectory shape;
+        int64_t strokeNs;
+    };
+
+    // Worker-owned except settings (any thread) and sink stats (read anywhere).
+    struct alignas(64) Stream {
+        SettingsCell settings;
+        std::unique_ptr<InputSink> sink;
+        FixedPointIntegrator integrator;
+        CurvePlayer curve;
+        bool moving = false, curveMode = false;
+        double sensitivity = 0.0; // in force since the previous service
+        uint64_t index = 0;
+
+        Stream(std::unique_ptr<InputSink> s, const Trajectory* shape, const MotionSettings& init)
+            : settings(init), sink(std::move(s)), curve(shape, kCurveStrokeNs) {}
+    };
+
+    struct Due {
+        uint32_t id;
+        int64_t  deadlineNs;
+    };
+
+    struct Worker {
+        SpscRing<Due> inbox; // scheduler -> worker
+        SpscRing<Due> done;  // worker -> scheduler: next deadline, or kParkedNs
+        WakeEvent wake;
+        std::thread thread;
+        mutable std::mutex mx; // stats only
+        uint64_t services = 0;
+        LogHistogram late;
+        explicit Worker(size_t streams) : inbox(streams), done(streams) {}
+    };
+
+    Options opts;
+    Trajectory builtInCurve;
+    std::vector<CurveDef> curves;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::thread scheduler;
+    std::atomic<bool> stopping{false};
+
+    // Scheduler-owned.
+    std::unique_ptr<TimerWheel> wheel;
+    std::vector<uint8_t> where, kicked;
+    size_t kickedAtWorker = 0; // kicked[] entries set: streams to reschedule as soon as a worker returns them
+    WakeEvent wake;
+    std::atomic<int64_t> plannedWakeNs{0};
+    std::atomic<uint64_t> schedulerWakeups{0};
+
+    // Control plane: settings changes are rare, so a mutex is fine here.
+    std::mutex kickMx;
+    std::vector<uint32_t> kicks;
+
+    void kick(uint32_t id) {
+        {
+            std::lock_guard<std::mutex> lk(kickMx);
+            kicks.push_back(id);
+        }
+        wake.signal();
+    }
+
+    // -------- scheduler thread --------
+    void schedule() {
+        SteadyClock clock;
+        std::vector<uint32_t> pending;
+        Due buf[kBatch];
+        for (;;) {
+            if (stopping.load(std::memory_order_acquire)) return;
+            int64_t now = clock.nowNs();
+
+            for (auto& w : workers) {
+                size_t n;
+                while ((n = w->done.popBatch(buf, kBatch)) != 0)
+                    for (size_t i = 0; i < n; ++i) finished(buf[i], now);
+            }
+            {
+                std::lock_guard<std::mutex> lk(kickMx);
+                pending.swap(kicks);
+            }
+            for (uint32_t id : pending) {
+                if (where[id] == AtWorker) { kickedAtWorker += !kicked[id]; kicked[id] = 1; }
+                else { wheel->schedule(id, now); where[id] = InWheel; }
+            }
+            pending.clear();
+
+            now = clock.nowNs();
+            uint32_t signalMask = 0; // first 32 workers tracked exactly, the rest always signalled
+            wheel->expire(now, [&](uint32_t id, int64_t deadlineNs) {
+                const uint32_t w = id % uint32_t(workers.size());
+                where[id] = AtWorker;
+                workers[w]->inbox.push(Due{ id, deadlineNs }); // sized for every stream: never full
+                signalMask |= w < 32 ? (1u << w) : 0u;
+                if (w >= 32) workers[w]->wake.signal();
+            });
+            for (uint32_t w = 0; signalMask; ++w, signalMask >>= 1)
+                if (signalMask & 1) workers[w]->wake.signal();
+
+            // Publish the planned wake-up before re-checking the rings; a worker that returns an
+            // earlier deadline after this point sees it and signals. While a kicked stream is still
+            // at a worker, kParkedNs asks for a signal on any return, whatever its deadline.
+            const int64_t next = std::min(wheel->nextDeadlineNs(), now + kIdleNs);
+            plannedWakeNs.store(kickedAtWorker ? kParkedNs : next, std::memory_order_seq_cst);
+            wake.clear();
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool busy = false;
+            for (auto& w : workers) busy = busy || w->done.sizeApprox() != 0;
+            if (busy) continue;
+            clock.sleepUntil(next, opts.spinNs, &wake);
+            schedulerWakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void finished(const Due& d, int64_t now) {
+        if (kicked[d.id]) {
+            kicked[d.id] = 0;
+            --kickedAtWorker;
+            wheel->schedule(d.id, now);
+            where[d.id] = InWheel;
+        } else if (d.deadlineNs == kParkedNs) {
+            where[d.id] = Parked;
+        } else {
+            wheel->schedule(d.id, d.deadlineNs);
+            where[d.id] = InWheel;
+        }
+    }
+
+    // -------- worker threads --------
+    void work(unsigned index) {
+        Worker& w = *workers[index];
+        SteadyClock clock;
+        Due buf[kBatch];
+        uint64_t lateNs[kBatch];
+        for (;;) {
+            const size_t n = w.inbox.popBatch(buf, kBatch);
+            if (!n) {
+                if (stopping.load(std::memory_order_acquire)) return;
+                w.wake.clear();
+                if (w.inbox.sizeApprox() == 0 && !stopping.load(std::memory_order_acquire))
+                    clock.sleepUntil(clock.nowNs() + kIdleNs, 0, &w.wake);
+                continue;
+            }
+            int64_t earliest = kParkedNs;
+            for (size_t i = 0; i < n; ++i) {
+                const int64_t now = clock.nowNs();
+                lateNs[i] = uint64_t(now > buf[i].deadlineNs ? now - buf[i].deadlineNs : 0);
+                const int64_t next = service(*streams[buf[i].id], buf[i].deadlineNs, now);
+                w.done.push(Due{ buf[i].id, next });
+                earliest = std::min(earliest, next);
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t planned = plannedWakeNs.load(std::memory_order_seq_cst);
+            if (earliest < planned || planned == kParkedNs) wake.signal();
+            std::lock_guard<std::mutex> lk(w.mx);
+            w.services += n;
+            for (size_t i = 0; i < n; ++i) w.late.record(lateNs[i]);
+        }
+    }
+
+    const Trajectory* curveShape(int32_t index, int64_t& strokeNs) const {
+        if (index >= 0 && size_t(index) < curves.size()) {
+            strokeNs = curves[size_t(index)].strokeNs;
+            return &curves[size_t(index)].shape;
+        }
+        strokeNs = kCurveStrokeNs;
+        return &builtInCurve;
+    }
+
+    static void flushCurve(Stream& s) {
+        if (!s.curve.active()) return;
+        int dx = 0, dy = 0;
+        s.curve.finish(dx, dy);
+        if (dx || dy) s.sink->moveRelative(dx, dy);
+    }
+
+    // One wake-up of one stream: emit what is due, adopt the current settings, return the next deadline.
+    int64_t service(Stream& s, int64_t scheduledNs, int64_t now) {
+        const MotionSettings cfg = s.settings.load();
+        if (s.moving) {
+            const Tick tick{ s.index++, scheduledNs, now, 0, 0 };
+            const StepResult step = s.integrator.step(s.sensitivity, tick);
+            if (s.curveMode) {
+                int dx = 0, dy = 0;
+                if (step.dy > 0) s.curve.start(now, 0, step.dy);
+                s.curve.advance(now, dx, dy);
+                if (dx || dy) s.sink->moveRelative(dx, dy);
+            } else if (step.dy) {
+                s.sink->moveRelative(0, step.dy);
+            }
+        }
+        if (!cfg.enabled) {
+            flushCurve(s);
+            s.moving = false;
+            return kParkedNs;
+        }
+        if (!s.moving) {
+            s.integrator.reset(now);
+            s.curve.reset();
+            s.moving = true;
+        }
+        int64_t strokeNs;
+        const Trajectory* shape = curveShape(cfg.curve, strokeNs);
+        if (!cfg.curvePattern || shape != s.curve.trajectory()) {
+            flushCurve(s);
+            s.curve.setTrajectory(shape);
+            s.curve.setStrokeNs(strokeNs);
+        }
+        s.curveMode = cfg.curvePattern;
+        s.sensitivity = cfg.sensitivity;
+
+        if (s.curveMode) {
+            const int64_t period = 1000000000 / kCurveRateHz;
+            int64_t next = scheduledNs + period;
+            if (next <= now) next = now + period - (now - scheduledNs) % period; // skip missed grid points
+            return next;
+        }
+        return std::min(s.integrator.nextPixelNs(s.sensitivity), now + kMaxSleepNs);
+    }
+};
+
+} // namespace redmouse
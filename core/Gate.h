@@ -0,0 +1,60 @@
+// Gate.h — open/closed latch the motion thread parks on while there is nothing to do
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace redmouse {
+
+enum class GateWait : uint8_t { Open, Timeout, Released };
+
+class Gate {
+public:
+    // Any thread. Opening wakes the parked waiter (futex/keyed-event wake, a few µs).
+    void set(bool open) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            if (isOpenLocked == open) return;
+            isOpenLocked = open;
+            openFlag.store(open, std::memory_order_release);
+        }
+        if (open) cv.notify_all();
+    }
+
+    // Hot path: lock-free peek.
+    bool isOpen() const { return openFlag.load(std::memory_order_acquire); }
+
+    // Blocks until open or released. Returns false once released (shutdown).
+    bool wait() {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&] { return isOpenLocked || released; });
+        return !released;
+    }
+
+    // wait() with a time limit, so the caller can do idle-only work and then park for good.
+    GateWait waitFor(std::chrono::nanoseconds timeout) {
+        std::unique_lock<std::mutex> lk(m);
+        if (!cv.wait_for(lk, timeout, [&] { return isOpenLocked || released; })) return GateWait::Timeout;
+        return released ? GateWait::Released : GateWait::Open;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            released = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    std::mutex m;
+    std::condition_variable cv;
+    bool isOpenLocked = false;
+    bool released = false;
+    std::atomic<bool> openFlag{false};
+};
+
+} // namespace redmouse
@@ -0,0 +1,184 @@
+// InjectQueue.h — hands moves from the motion thread to an injector thread that batches them
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Clock.h"
+#include "InputSink.h"
+#include "SpscRing.h"
+#include "Telemetry.h"
+
+namespace redmouse {
+
+enum class InjectMode : uint8_t {
+    Direct,   // no queue: the motion thread calls the backend itself
+    Batch,    // every move kept, sent as one INPUT array / one uinput write per batch
+    Coalesce, // moves in a batch summed into a single move
+};
+
+inline const char* injectModeName(InjectMode m) {
+    switch (m) {
+    case InjectMode::Batch:    return "batch";
+    case InjectMode::Coalesce: return "coalesce";
+    default:                   return "direct";
+    }
+}
+
+struct InjectorStats {
+    uint64_t moves = 0;         // moves taken off the queue
+    uint64_t batches = 0;       // backend calls made for them
+    uint64_t syscalls = 0;      // syscalls the backend reported for those calls (SinkStats)
+    uint64_t syscallsSaved = 0; // versus one syscall per move; 0 for backends that make none (mock)
+    bool     backendSyscalls = false; // the backend has made at least one syscall: syscallsSaved means something
+    uint64_t wakeups = 0;       // times the injector was woken from idle
+    uint64_t dropped = 0;       // moves lost because the queue was full
+    uint64_t delayP50Ns = 0, delayP99Ns = 0, delayMaxNs = 0; // push -> backend call
+};
+
+// An InputSink that only enqueues. moveRelative() is a ring push plus, when the injector is idle,
+// one wake signal; the backend call happens on the injector thread. A move that follows a quiet
+// spell (nothing sent for budgetNs) goes out at once; otherwise the batch is flushed when its oldest
+// move reaches budgetNs, less the wake-up lateness the injector has seen. The last spinNs of that
+// wait is a busy-wait, as in TickScheduler, so a typical move waits about budgetNs; budgetNs is a
+// target, not a hard bound: a thread the OS does not run in time still flushes late. The wake flag
+// stays set while the injector is busy, so pushes during a batch cost no syscall.
+class QueuedSink final : public InputSink {
+public:
+    struct Options {
+        InjectMode mode = InjectMode::Batch;
+        int64_t budgetNs = 1000000;
+        int64_t spinNs = 50000; // busy-wait tail before each flush; 0 disables
+        size_t capacity = 1024;
+    };
+
+    QueuedSink(std::unique_ptr<InputSink> backend, const Options& o)
+        : target(std::move(backend)), opts(o), ring(o.capacity) {
+        std::snprintf(label, sizeof(label), "%s+%s", target->name(), injectModeName(o.mode));
+        worker = std::thread(&QueuedSink::run, this);
+    }
+    ~QueuedSink() override { stop(); }
+    QueuedSink(const QueuedSink&) = delete;
+    QueuedSink& operator=(const QueuedSink&) = delete;
+
+    const char* name() const override { return label; }
+
+    bool moveRelative(int dx, int dy) override {
+        if (dx == 0 && dy == 0) return true;
+        if (!ring.push(Entry{ MoveDelta{ dx, dy }, steadyNowNs() })) { reject(); return false; }
+        account(0, 0, dx, dy);
+        wake.signal();
+        return true;
+    }
+
+    bool cursorPos(int& x, int& y) const override { return target->cursorPos(x, y); }
+
+    // Delivers everything still queued, then joins the injector. Idempotent.
+    void stop() {
+        if (!worker.joinable()) return;
+        stopping.store(true, std::memory_order_release);
+        wake.signal();
+        worker.join();
+    }
+
+    // The wrapped backend's own counters: real syscalls and events.
+    const InputSink& backend() const { return *target; }
+
+    InjectorStats injectorStats() const {
+        std::lock_guard<std::mutex> lk(mx);
+        InjectorStats s = totals;
+        s.dropped = ring.dropped();
+        s.delayP50Ns = delay.percentile(0.50);
+        s.delayP99Ns = delay.percentile(0.99);
+        s.delayMaxNs = delay.maxValue();
+        return s;
+    }
+
+private:
+    struct Entry {
+        MoveDelta m;
+        int64_t tNs;
+    };
+    static constexpr int64_t kIdleNs = 100000000; // re-check stopping this often while parked
+    static constexpr int64_t kGuardNs = 50000;    // initial allowance for a late wake-up
+
+    std::unique_ptr<InputSink> target;
+    Options opts;
+    SpscRing<Entry> ring;
+    WakeEvent wake;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+    char label[48] = {};
+
+    mutable std::mutex mx; // injector thread vs injectorStats(); never taken by the producer
+    InjectorStats totals;
+    LogHistogram delay;
+
+    void run() {
+#ifdef _WIN32
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#endif
+        SteadyClock clock;
+        Entry batch[kMaxMoveBatch];
+        MoveDelta out[kMaxMoveBatch];
+        int64_t lastMoveNs = INT64_MIN / 2; // push time of the last move sent
+        int64_t guardNs = std::min(kGuardNs, opts.budgetNs / 2);
+        for (;;) {
+            if (ring.sizeApprox() == 0) {
+                if (stopping.load(std::memory_order_acquire)) return;
+                // Clear, then re-check: a push that lands in between is seen here or wakes the sleep.
+                wake.clear();
+                if (ring.sizeApprox() == 0 && !stopping.load(std::memory_order_acquire)) {
+                    if (!clock.sleepUntil(clock.nowNs() + kIdleNs, 0, &wake)) {
+                        std::lock_guard<std::mutex> lk(mx);
+                        ++totals.wakeups;
+                    }
+                }
+                continue;
+            }
+            size_t n = ring.popBatch(batch, 1);
+            // After a quiet spell there is nothing to share the call with: send at once.
+            const bool quiet = batch[0].tNs - lastMoveNs >= opts.budgetNs;
+            const int64_t due = batch[0].tNs + opts.budgetNs - guardNs;
+            if (!quiet && !stopping.load(std::memory_order_acquire) && due > clock.nowNs()) {
+                clock.sleepUntil(due, opts.spinNs);
+                // Track the wake-up lateness as a slowly decaying maximum, capped so batching survives.
+                const int64_t late = clock.nowNs() - due;
+                guardNs = std::min(opts.budgetNs / 2, std::max(late, guardNs - guardNs / 16));
+            }
+            n += ring.popBatch(batch + 1, kMaxMoveBatch - 1);
+            lastMoveNs = batch[n - 1].tNs;
+            deliver(batch, out, n, clock.nowNs());
+        }
+    }
+
+    void deliver(const Entry* batch, MoveDelta* out, size_t n, int64_t nowNs) {
+        const uint64_t syscallsBefore = target->stats().syscalls;
+        size_t calls = 1;
+        if (opts.mode == InjectMode::Coalesce) {
+            MoveDelta sum{ 0, 0 };
+            for (size_t i = 0; i < n; ++i) { sum.dx += batch[i].m.dx; sum.dy += batch[i].m.dy; }
+            if (sum.dx || sum.dy) target->moveRelative(sum.dx, sum.dy);
+            else calls = 0; // moves that cancelled out cost nothing
+        } else {
+            for (size_t i = 0; i < n; ++i) out[i] = batch[i].m;
+            target->moveBatch(out, n);
+        }
+        const uint64_t syscalls = target->stats().syscalls - syscallsBefore;
+        std::lock_guard<std::mutex> lk(mx);
+        totals.moves += n;
+        totals.batches += calls;
+        totals.syscalls += syscalls;
+        totals.backendSyscalls = totals.backendSyscalls || syscalls > 0;
+        if (totals.backendSyscalls)
+            totals.syscallsSaved = totals.moves > totals.syscalls ? totals.moves - totals.syscalls : 0;
+        for (size_t i = 0; i < n; ++i) delay.record(uint64_t(nowNs - batch[i].tNs));
+    }
+};
+
+} // namespace redmouse
@@ -0,0 +1,305 @@
+// InputSink.h — pluggable pointer-injection backends (SendInput / uinput / in-memory)
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace redmouse {
+
+struct SinkStats {
+    uint64_t calls    = 0; // moveRelative/moveAbsolute invocations
+    uint64_t syscalls = 0; // kernel/user32 round-trips issued by the backend
+    uint64_t events   = 0; // OS-level input events delivered
+    uint64_t pixels   = 0; // |dx|+|dy| summed over delivered moves
+    uint64_t dropped  = 0; // moves the backend rejected
+};
+
+struct MoveDelta {
+    int32_t dx, dy;
+};
+
+// Called from a single producer (the motion thread); stats() may be read from any thread.
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool moveRelative(int dx, int dy) = 0;
+    // Several relative moves in order. Backends that can deliver them in one OS call override it.
+    virtual bool moveBatch(const MoveDelta* moves, size_t n) {
+        bool ok = true;
+        for (size_t i = 0; i < n; ++i) ok = moveRelative(moves[i].dx, moves[i].dy) && ok;
+        return ok;
+    }
+    // Absolute positioning is optional; relative-only backends refuse it.
+    virtual bool moveAbsolute(int x, int y) { (void)x; (void)y; reject(); return false; }
+    virtual bool cursorPos(int& x, int& y) const { x = y = 0; return false; }
+
+    SinkStats stats() const {
+        SinkStats s;
+        s.calls    = calls.load(std::memory_order_relaxed);
+        s.syscalls = syscalls.load(std::memory_order_relaxed);
+        s.events   = events.load(std::memory_order_relaxed);
+        s.pixels   = pixels.load(std::memory_order_relaxed);
+        s.dropped  = dropped.load(std::memory_order_relaxed);
+        return s;
+    }
+
+protected:
+    // Single writer: plain load+store keeps the counters off the LOCK-prefixed path.
+    static void bump(std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void account(uint64_t nSyscalls, uint64_t nEvents, int dx, int dy) {
+        bump(calls, 1);
+        bump(syscalls, nSyscalls);
+        bump(events, nEvents);
+        bump(pixels, uint64_t(dx < 0 ? -dx : dx) + uint64_t(dy < 0 ? -dy : dy));
+    }
+    void reject(uint64_t n = 1) { bump(calls, n); bump(dropped, n); }
+    void accountBatch(uint64_t nCalls, uint64_t nSyscalls, uint64_t nEvents, uint64_t nPixels) {
+        bump(calls, nCalls);
+        bump(syscalls, nSyscalls);
+        bump(events, nEvents);
+        bump(pixels, nPixels);
+    }
+    static uint64_t pixelsOf(const MoveDelta& m) {
+        return uint64_t(m.dx < 0 ? -m.dx : m.dx) + uint64_t(m.dy < 0 ? -m.dy : m.dy);
+    }
+
+private:
+    std::atomic<uint64_t> calls{0}, syscalls{0}, events{0}, pixels{0}, dropped{0};
+};
+
+// Largest batch a backend sends in one OS call; longer batches are split.
+inline constexpr size_t kMaxMoveBatch = 64;
+
+// -------- Windows: SendInput / SetCursorPos --------
+#ifdef _WIN32
+class SendInputSink final : public InputSink {
+public:
+    const char* name() const override { return "sendinput"; }
+
+    bool moveRelative(int dx, int dy) override {
+        if (dx == 0 && dy == 0) return true;
+        INPUT in{};
+        in.type = INPUT_MOUSE;
+        in.mi.dwFlags = MOUSEEVENTF_MOVE;
+        in.mi.dx = dx;
+        in.mi.dy = dy;
+        if (SendInput(1, &in, sizeof(INPUT)) != 1) { reject(); return false; }
+        account(1, 1, dx, dy);
+        return true;
+    }
+
+    // One INPUT array, one SendInput call.
+    bool moveBatch(const MoveDelta* moves, size_t n) override {
+        bool ok = true;
+        for (size_t base = 0; base < n; base += kMaxMoveBatch) {
+            INPUT in[kMaxMoveBatch];
+            UINT count = 0;
+            uint64_t px = 0;
+            for (size_t i = base; i < n && i < base + kMaxMoveBatch; ++i) {
+                if (moves[i].dx == 0 && moves[i].dy == 0) continue;
+                in[count] = INPUT{};
+                in[count].type = INPUT_MOUSE;
+                in[count].mi.dwFlags = MOUSEEVENTF_MOVE;
+                in[count].mi.dx = moves[i].dx;
+                in[count].mi.dy = moves[i].dy;
+                px += pixelsOf(moves[i]);
+                ++count;
+            }
+            if (!count) continue;
+            const UINT sent = SendInput(count, in, sizeof(INPUT));
+            if (sent != count) { reject(count - sent); ok = false; }
+            accountBatch(sent, 1, sent, sent == count ? px : 0);
+        }
+        return ok;
+    }
+
+    bool moveAbsolute(int x, int y) override {
+        if (!SetCursorPos(x, y)) { reject(); return false; }
+        account(1, 1, 0, 0);
+        return true;
+    }
+
+    bool cursorPos(int& x, int& y) const override {
+        POINT p;
+        if (!GetCursorPos(&p)) { x = y = 0; return false; }
+        x = p.x; y = p.y;
+        return true;
+    }
+};
+#endif
+
+// -------- Linux: /dev/uinput relative pointer --------
+#ifdef __linux__
+class UinputSink final : public InputSink {
+    int fd = -1;
+
+    bool emitSetup(const char* devName) {
+        if (ioctl(fd, UI_SET_EVBIT, EV_KEY) < 0) return false;
+        if (ioctl(fd, UI_SET_KEYBIT, BTN_LEFT) < 0) return false; // libinput only treats it as a mouse with a button
+        if (ioctl(fd, UI_SET_EVBIT, EV_REL) < 0) return false;
+        if (ioctl(fd, UI_SET_RELBIT, REL_X) < 0) return false;
+        if (ioctl(fd, UI_SET_RELBIT, REL_Y) < 0) return false;
+
+        uinput_setup us{};
+        us.id.bustype = BUS_VIRTUAL;
+        us.id.vendor  = 0x1d6b; // Linux Foundation
+        us.id.product = 0x0104;
+        std::strncpy(us.name, devName, UINPUT_MAX_NAME_SIZE - 1);
+        if (ioctl(fd, UI_DEV_SETUP, &us) < 0) return false;
+        return ioctl(fd, UI_DEV_CREATE) >= 0;
+    }
+
+public:
+    explicit UinputSink(const char* devName = "RedMouse virtual pointer") {
+        fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0 && !emitSetup(devName)) { ::close(fd); fd = -1; }
+    }
+    ~UinputSink() override {
+        if (fd >= 0) { ioctl(fd, UI_DEV_DESTROY); ::close(fd); }
+    }
+    UinputSink(const UinputSink&) = delete;
+    UinputSink& operator=(const UinputSink&) = delete;
+
+    bool ok() const { return fd >= 0; }
+    const char* name() const override { return "uinput"; }
+
+    bool moveRelative(int dx, int dy) override {
+        if (dx == 0 && dy == 0) return true;
+        if (fd < 0) { reject(); return false; }
+        // REL_X/REL_Y + SYN_REPORT go out in one write(): one syscall per move.
+        input_event ev[3]{};
+        int n = 0;
+        if (dx) { ev[n].type = EV_REL; ev[n].code = REL_X; ev[n].value = dx; ++n; }
+        if (dy) { ev[n].type = EV_REL; ev[n].code = REL_Y; ev[n].value = dy; ++n; }
+        ev[n].type = EV_SYN; ev[n].code = SYN_REPORT; ++n;
+        const ssize_t want = ssize_t(sizeof(input_event)) * n;
+        if (::write(fd, ev, size_t(want)) != want) { reject(); return false; }
+        account(1, uint64_t(n), dx, dy);
+        return true;
+    }
+
+    // Each move keeps its own SYN_REPORT frame; the frames share one write().
+    bool moveBatch(const MoveDelta* moves, size_t n) override {
+        if (fd < 0) { reject(n); return false; }
+        bool ok = true;
+        for (size_t base = 0; base < n; base += kMaxMoveBatch) {
+            input_event ev[kMaxMoveBatch * 3]{};
+            size_t k = 0, frames = 0;
+            uint64_t px = 0;
+            for (size_t i = base; i < n && i < base + kMaxMoveBatch; ++i) {
+                const MoveDelta& m = moves[i];
+                if (m.dx == 0 && m.dy == 0) continue;
+                if (m.dx) { ev[k].type = EV_REL; ev[k].code = REL_X; ev[k].value = m.dx; ++k; }
+                if (m.dy) { ev[k].type = EV_REL; ev[k].code = REL_Y; ev[k].value = m.dy; ++k; }
+                ev[k].type = EV_SYN; ev[k].code = SYN_REPORT; ++k;
+                px += pixelsOf(m);
+                ++frames;
+            }
+            if (!frames) continue;
+            const ssize_t want = ssize_t(sizeof(input_event) * k);
+            if (::write(fd, ev, size_t(want)) != want) { reject(frames); ok = false; continue; }
+            accountBatch(frames, 1, k, px);
+        }
+        return ok;
+    }
+};
+#endif
+
+// -------- In-memory recorder (mock) --------
+// Preallocated, wait-free single-producer log. Readers see entries [0, size()) once size() is acquired.
+class RecordingSink final : public InputSink {
+public:
+    struct Event {
+        int64_t tNs;      // steady_clock nanoseconds, or the attached time source
+        int32_t x, y;     // delta, or target position when absolute
+        uint8_t absolute;
+    };
+
+    explicit RecordingSink(size_t capacity = 1u << 20) : log(capacity) {}
+
+    const char* name() const override { return "mock"; }
+
+    bool moveRelative(int dx, int dy) override {
+        if (dx == 0 && dy == 0) return true;
+        if (!push(dx, dy, false)) return false;
+        account(0, 1, dx, dy);
+        return true;
+    }
+
+    bool moveAbsolute(int x, int y) override {
+        if (!push(x, y, true)) return false;
+        account(0, 1, 0, 0);
+        cx = x; cy = y;
+        return true;
+    }
+
+    bool cursorPos(int& x, int& y) const override { x = cx; y = cy; return true; }
+
+    // Offline runs stamp events with virtual time, e.g. [](const void* c){ return ((const VirtualClock*)c)->nowNs(); }
+    using TimeSource = int64_t (*)(const void* ctx);
+    void setTimeSource(TimeSource fn, const void* ctx) { timeFn = fn; timeCtx = ctx; }
+
+    size_t size() const { return head.load(std::memory_order_acquire); }
+    size_t capacity() const { return log.size(); }
+    const Event& operator[](size_t i) const { return log[i]; }
+
+    // Not safe against a concurrent producer; call between runs.
+    void clear() { head.store(0, std::memory_order_release); cx = cy = 0; }
+
+private:
+    std::vector<Event> log;
+    std::atomic<size_t> head{0};
+    int cx = 0, cy = 0; // last absolute target, so cursorPos() works without a desktop
+    TimeSource timeFn = nullptr;
+    const void* timeCtx = nullptr;
+
+    bool push(int x, int y, bool absolute) {
+        const size_t i = head.load(std::memory_order_relaxed);
+        if (i >= log.size()) { reject(); return false; }
+        const int64_t t = timeFn ? timeFn(timeCtx)
+                                 : std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now().time_since_epoch()).count();
+        log[i] = Event{ t, int32_t(x), int32_t(y), uint8_t(absolute) };
+        head.store(i + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// -------- Factory --------
+// "sendinput" (Windows), "uinput" (Linux), "mock"; nullptr/"" picks the platform default.
+inline std::unique_ptr<InputSink> makeSink(const char* kind) {
+    const bool dflt = !kind || !*kind;
+#ifdef _WIN32
+    if (dflt || std::strcmp(kind, "sendinput") == 0) return std::make_unique<SendInputSink>();
+#elif defined(__linux__)
+    if (dflt || std::strcmp(kind, "uinput") == 0) {
+        auto s = std::make_unique<UinputSink>();
+        if (s->ok()) return s;
+        return nullptr;
+    }
+#endif
+    if (dflt || std::strcmp(kind, "mock") == 0) return std::make_unique<RecordingSink>();
+    return nullptr;
+}
+
+} // namespace redmouse
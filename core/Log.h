@@ -0,0 +1,453 @@
+// Log.h — asynchronous logger: per-thread rings of fixed-size binary records, formatted by a drain thread
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Clock.h"
+#include "SpscRing.h"
+
+namespace redmouse {
+
+enum class LogLevel : uint8_t { Debug, Info, Warn, Error, Off };
+
+inline const char* logLevelName(LogLevel l) {
+    switch (l) {
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Info:  return "info";
+    case LogLevel::Warn:  return "warn";
+    case LogLevel::Error: return "error";
+    default:              return "off";
+    }
+}
+
+inline bool parseLogLevel(const char* s, LogLevel& l) {
+    for (int i = 0; i <= int(LogLevel::Off); ++i)
+        if (std::strcmp(s, logLevelName(LogLevel(i))) == 0) { l = LogLevel(i); return true; }
+    return false;
+}
+
+inline constexpr size_t kMaxLogArgs = 8;
+inline constexpr uint64_t kLogSampleEvery = 64; // producers time every 64th call of their own
+
+enum class LogArg : uint8_t { I64, U64, F64, Str, Ptr };
+
+// One call, captured as-is. fmt is kept by pointer and must be a string literal; %s arguments are
+// copied into text (truncated to fit), everything else is stored as 8 raw bytes.
+struct LogRecord {
+    int64_t     ticks = 0; // cpuTicks(); the initializer makes new LogRecord[n] prefault every page of a ring
+    const char* fmt;
+    uint64_t    args[kMaxLogArgs];
+    LogArg      kinds[kMaxLogArgs];
+    uint8_t     level;
+    uint8_t     nargs;
+    uint8_t     textUsed;
+    char        text[101];
+};
+static_assert(sizeof(LogRecord) == 192, "log records are fixed-size");
+
+struct LogStats {
+    uint64_t records = 0;   // accepted into a ring
+    uint64_t dropped = 0;   // ring full: producers never wait for the drain
+    uint64_t threads = 0;   // rings, one per thread that has logged
+    uint64_t bytes = 0;     // formatted output written
+    uint64_t rotations = 0;
+    uint64_t wakes = 0;      // calls that signalled the drain thread (the first record after a drain)
+    double   producerNs = 0; // mean cost of one call on the logging thread, wake-ups included
+    double   wakeNs = 0;     // mean cost of a call that signalled the drain thread
+    double   drainNs = 0;    // drain-thread time per record: sort, format, write
+};
+
+namespace detail {
+
+inline void logPutStr(LogRecord& r, size_t i, const char* s, size_t n) {
+    r.kinds[i] = LogArg::Str;
+    size_t room = sizeof(r.text) - r.textUsed;
+    if (room == 0) { r.args[i] = sizeof(r.text) - 1; return; } // the last byte is always '\0'
+    if (n > room - 1) n = room - 1;
+    std::memcpy(r.text + r.textUsed, s, n);
+    r.text[r.textUsed + n] = 0;
+    r.args[i] = r.textUsed;
+    r.textUsed = uint8_t(r.textUsed + n + 1);
+}
+
+template <class T>
+void logPut(LogRecord& r, size_t i, const T& v) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>) {
+        logPutStr(r, i, v, std::strlen(v));
+    } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+        const char* s = v ? v : "(null)";
+        logPutStr(r, i, s, std::strlen(s));
+    } else if constexpr (std::is_same_v<D, std::string>) {
+        logPutStr(r, i, v.data(), v.size());
+    } else if constexpr (std::is_floating_point_v<D>) {
+        const double d = double(v);
+        std::memcpy(&r.args[i], &d, sizeof(d));
+        r.kinds[i] = LogArg::F64;
+    } else if constexpr (std::is_enum_v<D>) {
+        logPut(r, i, std::underlying_type_t<D>(v));
+    } else if constexpr (std::is_integral_v<D>) {
+        r.args[i] = uint64_t(v); // sign-extended for signed types
+        r.kinds[i] = std::is_signed_v<D> ? LogArg::I64 : LogArg::U64;
+    } else {
+        static_assert(std::is_pointer_v<D>, "unsupported log argument type");
+        r.args[i] = uint64_t(reinterpret_cast<uintptr_t>(v));
+        r.kinds[i] = LogArg::Ptr;
+    }
+}
+
+inline double logF64(const LogRecord& r, size_t i) {
+    if (r.kinds[i] == LogArg::F64) { double d; std::memcpy(&d, &r.args[i], sizeof(d)); return d; }
+    return r.kinds[i] == LogArg::I64 ? double(int64_t(r.args[i])) : double(r.args[i]);
+}
+
+inline uint64_t logU64(const LogRecord& r, size_t i) {
+    return r.kinds[i] == LogArg::F64 ? uint64_t(int64_t(logF64(r, i))) : r.args[i];
+}
+
+} // namespace detail
+
+// printf semantics for the conversions the codebase uses (d i u x X o c f e g a s p and %%), with
+// flags, width and precision. Length modifiers are ignored: integers are always 64-bit here.
+inline size_t formatLogRecord(const LogRecord& r, char* out, size_t cap) {
+    size_t n = 0, ai = 0;
+    auto room = [&] { return n < cap ? cap - n : 0; };
+    auto put = [&](int w) { if (w > 0) n += std::min(size_t(w), room() ? room() - 1 : 0); };
+    for (const char* p = r.fmt; *p && n + 1 < cap; ++p) {
+        if (*p != '%') { out[n++] = *p; continue; }
+        if (p[1] == '%') { out[n++] = '%'; ++p; continue; }
+        const char* start = p;
+        char spec[32] = "%";
+        size_t s = 1;
+        const char* q = p + 1;
+        while (*q && std::strchr("-+ #0123456789.", *q) && s < sizeof(spec) - 4) spec[s++] = *q++;
+        while (*q && std::strchr("hlLqjzt", *q)) ++q;
+        const char c = *q;
+        if (!c || ai >= r.nargs) { out[n++] = '%'; continue; } // malformed: print the rest verbatim
+        p = q;
+        switch (c) {
+        case 'd': case 'i':
+            spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = 'd'; spec[s] = 0;
+            put(std::snprintf(out + n, room(), spec, (long long)detail::logU64(r, ai)));
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = c; spec[s] = 0;
+            put(std::snprintf(out + n, room(), spec, (unsigned long long)detail::logU64(r, ai)));
+            break;
+        case 'c':
+            spec[s++] = 'c'; spec[s] = 0;
+            put(std::snprintf(out + n, room(), spec, int(detail::logU64(r, ai))));
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec[s++] = c; spec[s] = 0;
+            put(std::snprintf(out + n, room(), spec, detail::logF64(r, ai)));
+            break;
+        case 's':
+            spec[s++] = 's'; spec[s] = 0;
+            put(std::snprintf(out + n, room(), spec, r.kinds[ai] == LogArg::Str ? r.text + r.args[ai] : "?"));
+            break;
+        case 'p':
+            put(std::snprintf(out + n, room(), "%p", reinterpret_cast<void*>(uintptr_t(r.args[ai]))));
+            break;
+        default:
+            out[n++] = '%';
+            p = start;
+            continue;
+        }
+        ++ai;
+    }
+    if (cap) out[std::min(n, cap - 1)] = 0;
+    return std::min(n, cap ? cap - 1 : 0);
+}
+
+// Producers (any thread) format nothing and take no lock after their first call: the level check,
+// one cpuTicks() read, the argument copies and a push into the thread's own SpscRing. A full ring
+// drops the record and counts it. The first record after a drain also signals the drain thread's
+// WakeEvent, one lock-free syscall per batch that stats() reports apart (wakes, wakeNs). The drain
+// thread gives the burst drainIntervalNs to collect, then merges the rings by timestamp, formats,
+// and writes to stdout or to a size-rotated file (path, path.1 ... path.N). With nothing logged it
+// wakes only every idleWakeNs, as a backstop for a record pushed while the event was being cleared.
+class Logger {
+public:
+    struct Options {
+        LogLevel    level = LogLevel::Info;
+        std::string path;                         // empty: console
+        uint64_t    maxFileBytes = 1u << 20;      // rotate when the current file would pass this
+        unsigned    keepFiles = 3;                // rotated files kept beside the current one
+        size_t      ringRecords = 512;            // per thread, 192 bytes each
+        int64_t     drainIntervalNs = 10000000;   // batching window after the first pending record
+        int64_t     idleWakeNs = 1000000000;      // longest sleep with nothing pending
+        bool        discard = false;              // format and count but write nothing (benchmarks)
+    };
+
+    Logger() : id(nextId()) {}
+    ~Logger() { stop(); }
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Records written before start() wait in their rings. Returns false when the file can't be
+    // opened; the logger then writes to the console instead.
+    bool start(const Options& o) {
+        if (worker.joinable()) return false;
+        opts = o;
+        {
+            std::lock_guard<std::mutex> lk(ringsMx);
+            ringRecords = o.ringRecords;
+        }
+        lvl.store(o.level, std::memory_order_relaxed);
+        startNs = steadyNowNs();
+        startTicks = cpuTicks();
+        bool ok = true;
+        if (!opts.path.empty()) {
+            file = std::fopen(opts.path.c_str(), "a");
+            if (file && std::fseek(file, 0, SEEK_END) == 0) fileBytes = uint64_t(std::max(0L, std::ftell(file)));
+            ok = file != nullptr;
+        }
+        stopping.store(false, std::memory_order_relaxed);
+        stopWake.clear();
+        wake.clear();
+        worker = std::thread(&Logger::run, this);
+        return ok;
+    }
+
+    // Drains everything logged so far and joins the drain thread. Idempotent.
+    void stop() {
+        if (!worker.joinable()) return;
+        stopping.store(true, std::memory_order_release);
+        stopWake.signal();
+        wake.signal();
+        worker.join();
+        if (file) { std::fclose(file); file = nullptr; }
+    }
+
+    // Drain now, on the calling thread (e.g. before something else writes to the console). Like a
+    // drain-thread pass, it clears the wake event first, so the next record signals again.
+    void flush() {
+        if (!worker.joinable()) return;
+        wake.clear();
+        drain();
+    }
+
+    void setLevel(LogLevel l) { lvl.store(l, std::memory_order_relaxed); }
+    LogLevel level() const { return lvl.load(std::memory_order_relaxed); }
+    bool enabled(LogLevel l) const { return l >= lvl.load(std::memory_order_relaxed); }
+
+    template <class... A>
+    void write(LogLevel l, const char* fmt, const A&... a) {
+        static_assert(sizeof...(A) <= kMaxLogArgs, "too many log arguments");
+        if (l < lvl.load(std::memory_order_relaxed)) return;
+        ThreadRing* tr = threadRing();
+        const int64_t t = cpuTicks();
+        const bool ok = tr->ring.pushWith([&](LogRecord& r) {
+            r.ticks = t;
+            r.fmt = fmt;
+            r.level = uint8_t(l);
+            r.nargs = uint8_t(sizeof...(A));
+            r.textUsed = 0;
+            size_t i = 0;
+            (detail::logPut(r, i++, a), ...);
+            (void)i;
+        });
+        if (!ok) return;
+        if (!wake.isSet()) {
+            wake.signal();
+            tr->wakes.store(tr->wakes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            tr->wakeTicks.store(tr->wakeTicks.load(std::memory_order_relaxed) + uint64_t(cpuTicks() - t),
+                                std::memory_order_relaxed);
+        }
+        const uint64_t n = tr->records.load(std::memory_order_relaxed) + 1;
+        tr->records.store(n, std::memory_order_relaxed);
+        if (n % kLogSampleEvery == 0) {
+            tr->sampledTicks.store(tr->sampledTicks.load(std::memory_order_relaxed) + uint64_t(cpuTicks() - t),
+                                   std::memory_order_relaxed);
+            tr->samples.store(tr->samples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    template <class... A> void debug(const char* fmt, const A&... a) { write(LogLevel::Debug, fmt, a...); }
+    template <class... A> void info(const char* fmt, const A&... a)  { write(LogLevel::Info, fmt, a...); }
+    template <class... A> void warn(const char* fmt, const A&... a)  { write(LogLevel::Warn, fmt, a...); }
+    template <class... A> void error(const char* fmt, const A&... a) { write(LogLevel::Error, fmt, a...); }
+
+    LogStats stats() const {
+        LogStats s;
+        uint64_t sampled = 0, samples = 0, wakeTicks = 0;
+        {
+            std::lock_guard<std::mutex> lk(ringsMx);
+            s.threads = rings.size();
+            for (const auto& tr : rings) {
+                s.records += tr->records.load(std::memory_order_relaxed);
+                s.dropped += tr->ring.dropped();
+                sampled += tr->sampledTicks.load(std::memory_order_relaxed);
+                samples += tr->samples.load(std::memory_order_relaxed);
+                s.wakes += tr->wakes.load(std::memory_order_relaxed);
+                wakeTicks += tr->wakeTicks.load(std::memory_order_relaxed);
+            }
+        }
+        // The sampled calls stand for the plain ones; the signalling calls are all timed.
+        const double nsTick = nsPerTick(cpuTicks(), steadyNowNs());
+        const double plainNs = samples ? double(sampled) * nsTick / double(samples) : 0.0;
+        s.wakeNs = s.wakes ? double(wakeTicks) * nsTick / double(s.wakes) : 0.0;
+        if (s.records)
+            s.producerNs = (plainNs * double(s.records - std::min(s.wakes, s.records)) + s.wakeNs * double(s.wakes)) /
+                           double(s.records);
+        s.bytes = bytesOut.load(std::memory_order_relaxed);
+        s.rotations = rotations.load(std::memory_order_relaxed);
+        const uint64_t d = drained.load(std::memory_order_relaxed);
+        s.drainNs = d ? double(drainTotalNs.load(std::memory_order_relaxed)) / double(d) : 0.0;
+        return s;
+    }
+
+private:
+    struct ThreadRing {
+        explicit ThreadRing(size_t n, std::thread::id t) : ring(n), owner(t) {}
+        SpscRing<LogRecord> ring;
+        std::thread::id owner;
+        // Written by the owning thread only.
+        std::atomic<uint64_t> records{0}, sampledTicks{0}, samples{0}, wakes{0}, wakeTicks{0};
+    };
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> ids{0};
+        return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Cached per thread; the lock is only taken on a thread's first call (or after switching loggers).
+    ThreadRing* threadRing() {
+        thread_local uint64_t cachedId = 0;
+        thread_local ThreadRing* cached = nullptr;
+        if (cachedId == id) return cached;
+        const std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lk(ringsMx);
+        cached = nullptr;
+        for (const auto& tr : rings)
+            if (tr->owner == self) cached = tr.get();
+        if (!cached) {
+            rings.push_back(std::make_unique<ThreadRing>(ringRecords, self));
+            cached = rings.back().get();
+        }
+        cachedId = id;
+        return cached;
+    }
+
+    void run() {
+        SteadyClock clock;
+        while (!stopping.load(std::memory_order_acquire)) {
+            const bool woken = !clock.sleepUntil(clock.nowNs() + opts.idleWakeNs, 0, &wake);
+            if (stopping.load(std::memory_order_acquire)) break;
+            // The burst window; only stop() cuts it short, since the wake event stays set through it.
+            if (woken) clock.sleepUntil(clock.nowNs() + opts.drainIntervalNs, 0, &stopWake);
+            wake.clear(); // records pushed from here on signal again
+            drain();
+        }
+        drain();
+    }
+
+    // ns per cpuTicks() tick, measured from start() to now (exactly 1 without a TSC).
+    double nsPerTick(int64_t nowTicks, int64_t nowNs) const {
+        const int64_t dt = nowTicks - startTicks;
+        return dt > 0 && nowNs > startNs ? double(nowNs - startNs) / double(dt) : 1.0;
+    }
+
+    void drain() {
+        std::lock_guard<std::mutex> dl(drainMx);
+        const int64_t t0 = steadyNowNs();
+        {
+            std::lock_guard<std::mutex> lk(ringsMx);
+            active.clear();
+            for (const auto& tr : rings) active.push_back(tr.get());
+        }
+        batch.clear();
+        LogRecord r;
+        for (ThreadRing* tr : active)
+            while (tr->ring.pop(r)) batch.push_back(r);
+        if (batch.empty()) return;
+        // Each ring is already in order; this interleaves the threads.
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const LogRecord& a, const LogRecord& b) { return a.ticks < b.ticks; });
+        // Ticks -> ns, anchored at now so the conversion error stays within one batch.
+        const int64_t nowTicks = cpuTicks(), nowNs = steadyNowNs();
+        const double ratio = nsPerTick(nowTicks, nowNs);
+        for (const LogRecord& rec : batch) emit(rec, nowNs - int64_t(double(nowTicks - rec.ticks) * ratio));
+        if (!opts.discard) std::fflush(file ? file : stdout);
+        drained.fetch_add(batch.size(), std::memory_order_relaxed);
+        drainTotalNs.fetch_add(uint64_t(steadyNowNs() - t0), std::memory_order_relaxed);
+    }
+
+    void emit(const LogRecord& rec, int64_t tNs) {
+        char line[1024];
+        size_t n = formatLogRecord(rec, line, sizeof(line));
+        if (opts.discard) { bytesOut.fetch_add(n, std::memory_order_relaxed); return; }
+        if (!file) {
+            std::fwrite(line, 1, n, stdout);
+            bytesOut.fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        // Files get a time/level prefix and no ANSI colour sequences.
+        char out[1100];
+        size_t m = size_t(std::max(0, std::snprintf(out, sizeof(out), "%12.6f %-5s ",
+                                                    double(tNs - startNs) * 1e-9, logLevelName(LogLevel(rec.level)))));
+        for (size_t i = 0; i < n && m + 1 < sizeof(out); ++i) {
+            if (line[i] == '\033' && i + 1 < n && line[i + 1] == '[') {
+                i += 2;
+                while (i < n && !(line[i] >= '@' && line[i] <= '~')) ++i;
+                continue;
+            }
+            out[m++] = line[i];
+        }
+        if (m == 0 || out[m - 1] != '\n') out[m++] = '\n';
+        if (fileBytes + m > opts.maxFileBytes && fileBytes > 0) rotate();
+        if (!file) return;
+        std::fwrite(out, 1, m, file);
+        fileBytes += m;
+        bytesOut.fetch_add(m, std::memory_order_relaxed);
+    }
+
+    void rotate() {
+        std::fclose(file);
+        const std::string& p = opts.path;
+        if (opts.keepFiles == 0) std::remove(p.c_str());
+        for (unsigned i = opts.keepFiles; i > 0; --i) {
+            const std::string to = p + "." + std::to_string(i);
+            std::remove(to.c_str());
+            std::rename(i == 1 ? p.c_str() : (p + "." + std::to_string(i - 1)).c_str(), to.c_str());
+        }
+        file = std::fopen(p.c_str(), "w");
+        fileBytes = 0;
+        rotations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const uint64_t id;
+    Options opts;
+    std::atomic<LogLevel> lvl{LogLevel::Info};
+    int64_t startNs = 0, startTicks = 0;
+
+    mutable std::mutex ringsMx;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    size_t ringRecords = 512;
+
+    std::mutex drainMx; // drain thread vs flush(); owns everything below
+    std::vector<ThreadRing*> active;
+    std::vector<LogRecord> batch;
+    std::FILE* file = nullptr;
+    uint64_t fileBytes = 0;
+
+    alignas(64) WakeEvent wake; // producers read its flag on every call; signalled and cleared once per batch
+    WakeEvent stopWake;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+
+    std::atomic<uint64_t> bytesOut{0}, rotations{0}, drained{0}, drainTotalNs{0};
+};
+
+} // namespace redmouse
@@ -0,0 +1,257 @@
+// MappedFile.h — read-only file mapping plus a directory watcher that reports when one file changes
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace redmouse {
+
+// The whole file, mapped read-only. File handles are closed once the view exists.
+// Replace mapped files by writing a new file and renaming it over the old one; truncating
+// a file in place while it is mapped faults readers on Linux.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const char* path) { open(path); }
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept : base(o.base), len(o.len) { o.base = nullptr; o.len = 0; }
+    MappedFile& operator=(MappedFile&& o) noexcept {
+        if (this != &o) { close(); base = o.base; len = o.len; o.base = nullptr; o.len = 0; }
+        return *this;
+    }
+
+    bool open(const char* path) {
+        close();
+#ifdef _WIN32
+        HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz{};
+        if (GetFileSizeEx(f, &sz) && sz.QuadPart > 0) {
+            if (HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                base = static_cast<const uint8_t*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+                if (base) len = size_t(sz.QuadPart);
+                CloseHandle(m);
+            }
+        }
+        CloseHandle(f);
+#elif defined(__linux__)
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) { base = static_cast<const uint8_t*>(p); len = size_t(st.st_size); }
+        }
+        ::close(fd);
+#endif
+        return base != nullptr;
+    }
+
+    void close() {
+        if (!base) return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#elif defined(__linux__)
+        munmap(const_cast<uint8_t*>(base), len);
+#endif
+        base = nullptr;
+        len = 0;
+    }
+
+    bool ok() const { return base != nullptr; }
+    const uint8_t* data() const { return base; }
+    size_t size() const { return len; }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t len = 0;
+};
+
+// Watches the directory of one file and calls onChange (on the watcher thread) once writes
+// have been quiet for debounceMs, so a multi-step save produces a single reload.
+class FileWatcher {
+public:
+    using Callback = std::function<void()>;
+
+    FileWatcher() = default;
+    ~FileWatcher() { stop(); }
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool start(const char* path, Callback onChange, int debounceMs = 100) {
+        stop();
+        std::string p(path);
+        const size_t slash = p.find_last_of("/\\");
+        dir  = slash == std::string::npos ? std::string(".") : p.substr(0, slash ? slash : 1);
+        name = slash == std::string::npos ? p : p.substr(slash + 1);
+        callback = std::move(onChange);
+        debounce = debounceMs;
+        if (!openBackend()) { closeBackend(); return false; }
+        stopping.store(false, std::memory_order_relaxed);
+        thread = std::thread([this] { loop(); });
+        return true;
+    }
+
+    void stop() {
+        if (!thread.joinable()) return;
+        stopping.store(true, std::memory_order_relaxed);
+#ifdef _WIN32
+        SetEvent(stopEvent);
+#elif defined(__linux__)
+        const uint64_t one = 1;
+        (void)!::write(stopFd, &one, sizeof(one));
+#endif
+        thread.join();
+        closeBackend();
+    }
+
+    uint64_t changes() const { return fired.load(std::memory_order_relaxed); }
+
+private:
+    std::string dir, name;
+    Callback callback;
+    int debounce = 100;
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> fired{0};
+
+    void notify() {
+        fired.fetch_add(1, std::memory_order_relaxed);
+        if (callback) callback();
+    }
+
+#ifdef _WIN32
+    HANDLE dirHandle = INVALID_HANDLE_VALUE;
+    HANDLE stopEvent = nullptr, ioEvent = nullptr;
+    std::wstring wname;
+
+    bool openBackend() {
+        dirHandle = CreateFileA(dir.c_str(), FILE_LIST_DIRECTORY,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        ioEvent   = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        const int n = MultiByteToWideChar(CP_ACP, 0, name.c_str(), -1, nullptr, 0);
+        wname.assign(size_t(n > 0 ? n - 1 : 0), L'\0');
+        if (n > 1) MultiByteToWideChar(CP_ACP, 0, name.c_str(), -1, &wname[0], n);
+        return dirHandle != INVALID_HANDLE_VALUE && stopEvent && ioEvent;
+    }
+
+    void closeBackend() {
+        if (dirHandle != INVALID_HANDLE_VALUE) CloseHandle(dirHandle);
+        if (stopEvent) CloseHandle(stopEvent);
+        if (ioEvent) CloseHandle(ioEvent);
+        dirHandle = INVALID_HANDLE_VALUE;
+        stopEvent = ioEvent = nullptr;
+    }
+
+    bool matches(const FILE_NOTIFY_INFORMATION* fi) const {
+        const int n = int(fi->FileNameLength / sizeof(WCHAR));
+        return n == int(wname.size()) &&
+               CompareStringOrdinal(fi->FileName, n, wname.c_str(), n, TRUE) == CSTR_EQUAL;
+    }
+
+    void loop() {
+        alignas(DWORD) uint8_t buf[4096];
+        OVERLAPPED ov{};
+        ov.hEvent = ioEvent;
+        bool pending = false;
+        bool armed = false;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            if (!armed) {
+                ResetEvent(ioEvent);
+                if (!ReadDirectoryChangesW(dirHandle, buf, sizeof(buf), FALSE,
+                                           FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME |
+                                               FILE_NOTIFY_CHANGE_SIZE,
+                                           nullptr, &ov, nullptr))
+                    break;
+                armed = true;
+            }
+            HANDLE hs[2] = { stopEvent, ioEvent };
+            const DWORD r = WaitForMultipleObjects(2, hs, FALSE, pending ? DWORD(debounce) : INFINITE);
+            if (r == WAIT_OBJECT_0) break;
+            if (r == WAIT_TIMEOUT) { pending = false; notify(); continue; }
+            DWORD bytes = 0;
+            armed = false;
+            if (!GetOverlappedResult(dirHandle, &ov, &bytes, FALSE)) continue;
+            if (bytes == 0) { pending = true; continue; } // buffer overflowed: assume our file changed
+            for (const uint8_t* p = buf;;) {
+                const auto* fi = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+                if (matches(fi)) pending = true;
+                if (!fi->NextEntryOffset) break;
+                p += fi->NextEntryOffset;
+            }
+        }
+        if (armed) {
+            CancelIo(dirHandle);
+            DWORD bytes = 0;
+            GetOverlappedResult(dirHandle, &ov, &bytes, TRUE);
+        }
+    }
+#elif defined(__linux__)
+    int inotifyFd = -1, stopFd = -1;
+
+    bool openBackend() {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        stopFd    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotifyFd < 0 || stopFd < 0) return false;
+        // Editors either rewrite in place (CLOSE_WRITE) or write a temp file and rename it (MOVED_TO).
+        return inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0;
+    }
+
+    void closeBackend() {
+        if (inotifyFd >= 0) ::close(inotifyFd);
+        if (stopFd >= 0) ::close(stopFd);
+        inotifyFd = stopFd = -1;
+    }
+
+    void loop() {
+        alignas(inotify_event) char buf[4096];
+        bool pending = false;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            pollfd fds[2] = { { stopFd, POLLIN, 0 }, { inotifyFd, POLLIN, 0 } };
+            const int r = poll(fds, 2, pending ? debounce : -1);
+            if (r < 0) continue;
+            if (fds[0].revents) break;
+            if (r == 0) { pending = false; notify(); continue; }
+            ssize_t n;
+            while ((n = ::read(inotifyFd, buf, sizeof(buf))) > 0) {
+                for (char* p = buf; p < buf + n;) {
+                    const auto* ev = reinterpret_cast<const inotify_event*>(p);
+                    if (ev->mask & IN_Q_OVERFLOW) pending = true;
+                    else if (ev->len && name == ev->name) pending = true;
+                    p += sizeof(inotify_event) + ev->len;
+                }
+            }
+        }
+    }
+#else
+    bool openBackend() { return false; }
+    void closeBackend() {}
+    void loop() {}
+#endif
+};
+
+} // namespace redmouse
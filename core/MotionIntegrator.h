@@ -0,0 +1,261 @@
+// MotionIntegrator.h — one motion core, specialised at compile time by timestep, clamp and output policies
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "TickScheduler.h"
+
+namespace redmouse {
+
+constexpr double kPixelsPerSecond = 40.0; // speed at sensitivity 1.0
+
+// What the sub-pixel accumulator holds when motion (re)starts on a button press. At ~42 px/s a
+// zero accumulator puts the first pixel ~24 ms after the press.
+enum class StartPolicy : uint8_t {
+    Zero,      // empty: first pixel after one full pixel of travel (the original behaviour)
+    Immediate, // one whole pixel: the first tick emits at once; each press adds < 1 px of travel
+    Half,      // half a pixel: rounds instead of truncating, halves the mean wait, unbiased over presses
+    Carry,     // the fraction left over from the previous hold: presses concatenate, nothing is lost
+};
+
+inline const char* startPolicyName(StartPolicy p) {
+    switch (p) {
+    case StartPolicy::Immediate: return "immediate";
+    case StartPolicy::Half:      return "half";
+    case StartPolicy::Carry:     return "carry";
+    default:                     return "zero";
+    }
+}
+
+inline bool parseStartPolicy(const char* s, StartPolicy& p) {
+    for (int i = 0; i <= int(StartPolicy::Carry); ++i)
+        if (std::strcmp(s, startPolicyName(StartPolicy(i))) == 0) { p = StartPolicy(i); return true; }
+    return false;
+}
+
+struct StepResult {
+    int     dy;    // whole pixels to emit now
+    float   dt;    // seconds this tick accounted for, before clamping
+    uint8_t flags; // TickFlags
+};
+
+// a*b/d and a*b%d with a 128-bit intermediate, d < 2^32. Plain 32-bit limbs, no compiler
+// intrinsics, so every target produces the same bits. The quotient must fit in 64 bits.
+inline uint64_t mulDivSmall(uint64_t a, uint64_t b, uint32_t d, uint32_t& rem) {
+    const uint64_t a0 = uint32_t(a), a1 = a >> 32, b0 = uint32_t(b), b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + uint32_t(p01) + uint32_t(p10);
+    const uint64_t lo = (mid << 32) | uint32_t(p00);
+    const uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    const uint32_t limbs[4] = { uint32_t(hi >> 32), uint32_t(hi), uint32_t(lo >> 32), uint32_t(lo) };
+    uint64_t r = 0, q = 0;
+    for (uint32_t limb : limbs) {
+        const uint64_t cur = (r << 32) | limb;
+        q = (q << 32) | (cur / d);
+        r = cur % d;
+    }
+    rem = uint32_t(r);
+    return q;
+}
+
+inline double toSeconds(double seconds) { return seconds; }
+inline double toSeconds(int64_t ns) { return double(ns) * 1e-9; }
+
+// -------- Timestep policies: how much time a tick represents --------
+
+// MouseRed.cpp: every tick is exactly one grid period; grid points the scheduler skipped are folded in.
+// The period comes from the tick, so a rate change mid-run needs no re-construction.
+class FixedTimestep {
+public:
+    void reset(int64_t) {}
+    double advance(const Tick& tick) { return double(tick.periodNs) * 1e-9 * (1 + tick.missed); }
+};
+
+// RedMouseV3beta.cpp: wall time since the previous tick.
+class MeasuredTimestep {
+public:
+    void reset(int64_t nowNs) { last = nowNs; }
+    double advance(const Tick& tick) {
+        const double dt = double(tick.actualNs - last) * 1e-9;
+        last = tick.actualNs;
+        return dt;
+    }
+
+private:
+    int64_t last = 0;
+};
+
+// Fixed-point mode: integer nanoseconds of wall time since the previous tick. Nothing is clamped or
+// dropped, so the tick after a stall or a skipped grid point pays back the whole elapsed time.
+class MeasuredNsTimestep {
+public:
+    void reset(int64_t nowNs) { last = nowNs; }
+    int64_t lastNs() const { return last; }
+    int64_t advance(const Tick& tick) {
+        const int64_t ns = tick.actualNs - last;
+        last = tick.actualNs;
+        return ns;
+    }
+
+private:
+    int64_t last = 0;
+};
+
+// -------- Clamp policies --------
+
+struct NoClamp {
+    template <class Delta> static Delta dt(Delta d, uint8_t&) { return d; }
+    template <class Output> static void acc(Output&, uint8_t&) {}
+};
+
+// Limits supplies static constexpr maxDt (s) and maxAcc (px).
+template <class Limits>
+struct FrameClamp {
+    static double dt(double d, uint8_t& flags) {
+        if (d > Limits::maxDt) { flags |= TickDtClamped; return Limits::maxDt; }
+        return d;
+    }
+    template <class Output> static void acc(Output& out, uint8_t& flags) {
+        if (out.clampAbove(Limits::maxAcc)) flags |= TickAccClamped;
+    }
+};
+
+struct StablePlusLimits {
+    static constexpr double maxDt  = 0.016; // frame clamp ~60Hz
+    static constexpr double maxAcc = 10.0;
+};
+
+// -------- Output policies: sub-pixel accumulator and whole-pixel quantiser --------
+
+class TruncatingOutput {
+public:
+    void reset() { acc = 0.0; }
+    void seed(double px) { acc = px; }
+    void add(double sensitivity, double seconds) { acc += sensitivity * kPixelsPerSecond * seconds; }
+    bool clampAbove(double maxPx) {
+        if (acc <= maxPx) return false;
+        acc = maxPx;
+        return true;
+    }
+    int take() {
+        const int px = static_cast<int>(acc);
+        if (px <= 0) return 0;
+        acc -= px;
+        return px;
+    }
+    double value() const { return acc; }
+
+private:
+    double acc = 0.0;
+};
+
+// Q32.32 pixels. Velocity is quantised once per sensitivity change to Q32.32 px/s; each tick adds
+// velocity*ns/1e9 and carries the division remainder, so a hold of total length T emits exactly
+// floor(velocity*T) pixels however it was sliced into ticks. Integer-only after quantisation.
+class FixedPointOutput {
+public:
+    static constexpr int     kFracBits = 32;
+    static constexpr int64_t kOne      = int64_t(1) << kFracBits;
+
+    void reset() { acc = 0; rem = 0; }
+    void seed(double px) { acc = int64_t(px * double(kOne)); rem = 0; }
+    void add(double sensitivity, int64_t ns) {
+        setVelocity(sensitivity);
+        if (ns <= 0 || velocity == 0) return;
+        uint32_t r;
+        acc += int64_t(mulDivSmall(velocity, uint64_t(ns), kNsPerSecond, r));
+        rem += r;
+        if (rem >= kNsPerSecond) { rem -= kNsPerSecond; ++acc; }
+    }
+    bool clampAbove(double maxPx) {
+        const int64_t cap = int64_t(maxPx * double(kOne));
+        if (acc <= cap) return false;
+        acc = cap;
+        rem = 0;
+        return true;
+    }
+    int take() {
+        const int64_t px = acc >> kFracBits;
+        if (px <= 0) return 0;
+        acc -= px << kFracBits;
+        return int(px);
+    }
+    double value() const { return double(acc) / double(kOne); }
+
+    // Smallest ns of further motion after which take() returns a pixel; INT64_MAX when not moving.
+    int64_t nsUntilNextPixel(double sensitivity) {
+        setVelocity(sensitivity);
+        if (acc >= kOne) return 0;
+        if (velocity == 0) return INT64_MAX;
+        const uint64_t need = uint64_t(kOne - acc) * kNsPerSecond - rem; // < 2^62
+        return int64_t((need + velocity - 1) / velocity);
+    }
+
+private:
+    static constexpr uint32_t kNsPerSecond = 1000000000u;
+
+    void setVelocity(double sensitivity) {
+        if (sensitivity == lastSensitivity) return;
+        lastSensitivity = sensitivity;
+        velocity = sensitivity > 0.0 ? uint64_t(std::llround(sensitivity * kPixelsPerSecond * double(kOne))) : 0;
+    }
+
+    int64_t  acc = 0;        // Q32.32 px
+    uint32_t rem = 0;        // remainder of the /1e9, in units of 2^-32 px / 1e9
+    uint64_t velocity = 0;   // Q32.32 px per second
+    double   lastSensitivity = -1.0;
+};
+
+// -------- Integrator --------
+
+// No runtime mode flags: each build instantiates exactly the combination it needs.
+template <class Timestep, class Clamp, class Output>
+class MotionIntegrator {
+public:
+    template <class... TimestepArgs>
+    explicit MotionIntegrator(TimestepArgs... args) : ts(args...) {}
+
+    void reset(int64_t nowNs) { ts.reset(nowNs); out.reset(); }
+
+    // Motion resumes at nowNs (button press): the clock restarts, the accumulator follows the policy.
+    void start(int64_t nowNs, StartPolicy policy) {
+        ts.reset(nowNs);
+        switch (policy) {
+        case StartPolicy::Zero:      out.reset(); break;
+        case StartPolicy::Immediate: out.seed(1.0); break;
+        case StartPolicy::Half:      out.seed(0.5); break;
+        case StartPolicy::Carry:     break; // take() already left only the fraction behind
+        }
+    }
+
+    StepResult step(double sensitivity, const Tick& tick) {
+        uint8_t flags = uint8_t(tick.missed ? TickMissed : 0);
+        const auto raw = ts.advance(tick);
+        out.add(sensitivity, Clamp::dt(raw, flags));
+        Clamp::acc(out, flags);
+        return StepResult{ out.take(), float(toSeconds(raw)), flags };
+    }
+
+    double accumulator() const { return out.value(); }
+
+    // Event-scheduled emission: absolute time at which the next whole pixel is due at this
+    // sensitivity (INT64_MAX if never). Only for timesteps with lastNs() and outputs with
+    // nsUntilNextPixel(), i.e. FixedPointIntegrator.
+    int64_t nextPixelNs(double sensitivity) {
+        const int64_t d = out.nsUntilNextPixel(sensitivity);
+        return d == INT64_MAX ? d : ts.lastNs() + d;
+    }
+
+private:
+    Timestep ts;
+    Output   out;
+};
+
+// The two shipping configurations, plus the drift-free mode either program can select (--integrator=q32).
+using FixedStepIntegrator  = MotionIntegrator<FixedTimestep, NoClamp, TruncatingOutput>;                      // MouseRed.cpp
+using ClampedDtIntegrator  = MotionIntegrator<MeasuredTimestep, FrameClamp<StablePlusLimits>, TruncatingOutput>; // V3
+using FixedPointIntegrator = MotionIntegrator<MeasuredNsTimestep, NoClamp, FixedPointOutput>;
+
+} // namespace redmouse
@@ -0,0 +1,16 @@
+// Presets.h — sensitivity defaults and the F2-F9 preset table shared by both executables
+#pragma once
+
+namespace redmouse {
+
+inline constexpr double kDefaultSensitivity = 1.0551;
+inline constexpr double kMinSensitivity     = 0.0;
+inline constexpr double kMaxSensitivity     = 20.0;
+inline constexpr double kSensitivityStep    = 0.00005; // Numpad +/-
+
+inline constexpr int    kPresetCount = 8;
+inline constexpr double kPresets[kPresetCount] = { // F2 .. F9
+    0.8571, 1.408, 1.15, 1.89965, 1.72225, 12.89035, 1.35955, 2.29865
+};
+
+} // namespace redmouse
@@ -0,0 +1,287 @@
+// Profile.h — versioned binary profile (named presets + curve definitions), read through a mapping
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Presets.h"
+#include "Trajectory.h"
+
+namespace redmouse {
+
+// -------- On-disk layout (little-endian, every record 8-byte aligned) --------
+//   ProfileHeader | PresetRecord[presetCount] | CurveRecord[curveCount] | SegmentRecord[segmentCount]
+// checksum is FNV-1a over every byte after the header.
+
+inline constexpr char     kProfileMagic[4]  = { 'R', 'M', 'P', 'F' };
+inline constexpr uint16_t kProfileVersion   = 1; // bump on any layout change; older readers reject newer files
+inline constexpr size_t   kProfileNameBytes = 24;
+inline constexpr uint32_t kProfileHeadless  = 1; // ProfileHeader::flags: V3 starts without its window
+
+struct ProfileHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t presetCount, presetOffset;
+    uint32_t curveCount, curveOffset;
+    uint32_t segmentCount, segmentOffset;
+    uint32_t checksum;
+    uint32_t flags;                    // kProfile* bits; 0 in files written before they existed
+};
+
+struct PresetRecord {
+    char     name[kProfileNameBytes];  // NUL-padded
+    double   sensitivity;
+    int32_t  curve;                    // CurveRecord index, -1 = built-in curve
+    uint32_t reserved;
+};
+
+struct CurveRecord {
+    char     name[kProfileNameBytes];
+    uint32_t firstSegment, segmentCount;
+    uint32_t strokeUs;                 // stroke duration
+    uint32_t samples;                  // LUT resolution, 0 = Trajectory::kDefaultSamples
+};
+
+struct SegmentRecord {
+    float    x[4], y[4];
+    float    weight;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ProfileHeader) == 40 && sizeof(PresetRecord) == 40 &&
+              sizeof(CurveRecord) == 40 && sizeof(SegmentRecord) == 40, "profile records are fixed-size");
+
+inline uint32_t fnv1a(const uint8_t* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// -------- Hotkey table --------
+// What the F2-F9 keys select. Plain data so it can be published through a Seqlock.
+struct PresetTable {
+    struct Entry {
+        char    name[kProfileNameBytes];
+        double  sensitivity;
+        int32_t curve;
+    };
+    Entry   entries[kPresetCount];
+    int32_t count;
+
+    static PresetTable builtIn() {
+        PresetTable t{};
+        for (int i = 0; i < kPresetCount; ++i) {
+            std::snprintf(t.entries[i].name, kProfileNameBytes, "F%d", i + 2);
+            t.entries[i].sensitivity = kPresets[i];
+            t.entries[i].curve = -1;
+        }
+        t.count = kPresetCount;
+        return t;
+    }
+};
+
+// -------- Loaded profile --------
+// load() validates the file through a read-only mapping, copies the records, builds the curve LUTs
+// and unmaps it again, all on the loading thread: whoever adopts the profile never compiles
+// anything, and the file is never held open (on Windows a live mapping makes the tools' atomic
+// replace of the file fail).
+class Profile {
+public:
+    static std::unique_ptr<Profile> load(const char* path, std::string* error = nullptr) {
+        std::unique_ptr<Profile> p(new Profile);
+        MappedFile map;
+        if (!map.open(path)) return fail(error, "cannot open/map profile");
+        const char* why = p->validate(map);
+        if (why) return fail(error, why);
+        p->compileCurves();
+        return p; // map closes here
+    }
+
+    // Serialises a profile image (the tools write it to a temp file and rename it into place).
+    static std::vector<uint8_t> build(const std::vector<PresetRecord>& presets, const std::vector<CurveRecord>& curves,
+                                      const std::vector<SegmentRecord>& segments, uint32_t flags = 0) {
+        ProfileHeader h{};
+        std::memcpy(h.magic, kProfileMagic, 4);
+        h.version = kProfileVersion;
+        h.headerSize = uint16_t(sizeof(ProfileHeader));
+        h.presetCount = uint32_t(presets.size());
+        h.presetOffset = uint32_t(sizeof(ProfileHeader));
+        h.curveCount = uint32_t(curves.size());
+        h.curveOffset = h.presetOffset + h.presetCount * uint32_t(sizeof(PresetRecord));
+        h.segmentCount = uint32_t(segments.size());
+        h.segmentOffset = h.curveOffset + h.curveCount * uint32_t(sizeof(CurveRecord));
+        h.flags = flags;
+
+        std::vector<uint8_t> out(h.segmentOffset + h.segmentCount * sizeof(SegmentRecord));
+        if (!presets.empty())  std::memcpy(&out[h.presetOffset], presets.data(), presets.size() * sizeof(PresetRecord));
+        if (!curves.empty())   std::memcpy(&out[h.curveOffset], curves.data(), curves.size() * sizeof(CurveRecord));
+        if (!segments.empty()) std::memcpy(&out[h.segmentOffset], segments.data(), segments.size() * sizeof(SegmentRecord));
+        h.checksum = fnv1a(out.data() + sizeof(ProfileHeader), out.size() - sizeof(ProfileHeader));
+        std::memcpy(out.data(), &h, sizeof(h));
+        return out;
+    }
+
+    const ProfileHeader& header() const { return hdr; }
+    uint32_t flags() const { return hdr.flags; }
+    size_t presetCount() const { return presets.size(); }
+    size_t curveCount() const { return curves.size(); }
+    const PresetRecord&  preset(size_t i) const { return presets[i]; }
+    const CurveRecord&   curveRecord(size_t i) const { return curves[i]; }
+    const SegmentRecord& segment(size_t i) const { return segments[i]; }
+
+    // Compiled curve, or nullptr for -1 / out of range (callers fall back to the built-in curve).
+    const Trajectory* curve(int32_t i) const {
+        return (i >= 0 && size_t(i) < compiled.size() && !compiled[i].empty()) ? &compiled[i] : nullptr;
+    }
+    int64_t strokeNs(int32_t i) const {
+        return (i >= 0 && size_t(i) < curveCount()) ? int64_t(curves[i].strokeUs) * 1000 : 0;
+    }
+
+    // First kPresetCount presets, in file order, become F2..F9.
+    PresetTable hotkeys() const {
+        PresetTable t{};
+        t.count = int32_t(presetCount() < size_t(kPresetCount) ? presetCount() : size_t(kPresetCount));
+        for (int32_t i = 0; i < t.count; ++i) {
+            std::memcpy(t.entries[i].name, presets[i].name, kProfileNameBytes);
+            t.entries[i].name[kProfileNameBytes - 1] = 0;
+            t.entries[i].sensitivity = presets[i].sensitivity;
+            t.entries[i].curve = presets[i].curve;
+        }
+        return t;
+    }
+
+private:
+    friend class ProfileHandoff;
+
+    ProfileHeader hdr{};
+    std::vector<PresetRecord>  presets;
+    std::vector<CurveRecord>   curves;
+    std::vector<SegmentRecord> segments;
+    std::vector<Trajectory> compiled;
+    Profile* retiredNext = nullptr;
+
+    Profile() = default;
+
+    static std::unique_ptr<Profile> fail(std::string* error, const char* why) {
+        if (error) *error = why;
+        return nullptr;
+    }
+
+    static bool section(const MappedFile& map, uint32_t offset, uint32_t count, size_t recSize) {
+        return offset % 8 == 0 && offset >= sizeof(ProfileHeader) &&
+               uint64_t(offset) + uint64_t(count) * recSize <= map.size();
+    }
+
+    // Copies a validated section out of the mapping.
+    template <class R>
+    static void copySection(const MappedFile& map, uint32_t offset, uint32_t count, std::vector<R>& out) {
+        out.resize(count);
+        if (count) std::memcpy(out.data(), map.data() + offset, size_t(count) * sizeof(R));
+    }
+
+    const char* validate(const MappedFile& map) {
+        if (map.size() < sizeof(ProfileHeader)) return "profile too small";
+        std::memcpy(&hdr, map.data(), sizeof(hdr));
+        if (std::memcmp(hdr.magic, kProfileMagic, 4) != 0) return "not a RedMouse profile";
+        if (hdr.version != kProfileVersion) return "unsupported profile version";
+        if (hdr.headerSize != sizeof(ProfileHeader)) return "bad header size";
+        if (!section(map, hdr.presetOffset, hdr.presetCount, sizeof(PresetRecord)) ||
+            !section(map, hdr.curveOffset, hdr.curveCount, sizeof(CurveRecord)) ||
+            !section(map, hdr.segmentOffset, hdr.segmentCount, sizeof(SegmentRecord)))
+            return "section out of bounds";
+        if (fnv1a(map.data() + sizeof(ProfileHeader), map.size() - sizeof(ProfileHeader)) != hdr.checksum)
+            return "checksum mismatch (partially written?)";
+
+        copySection(map, hdr.presetOffset, hdr.presetCount, presets);
+        copySection(map, hdr.curveOffset, hdr.curveCount, curves);
+        copySection(map, hdr.segmentOffset, hdr.segmentCount, segments);
+
+        for (const PresetRecord& r : presets) {
+            const double s = r.sensitivity;
+            if (!(s >= kMinSensitivity && s <= kMaxSensitivity)) return "preset sensitivity out of range";
+            if (r.curve < -1 || r.curve >= int32_t(hdr.curveCount)) return "preset names a missing curve";
+        }
+        for (const CurveRecord& c : curves) {
+            if (uint64_t(c.firstSegment) + c.segmentCount > hdr.segmentCount) return "curve segments out of bounds";
+            if (c.strokeUs == 0 || c.samples > 4096) return "bad curve timing";
+        }
+        return nullptr;
+    }
+
+    void compileCurves() {
+        compiled.resize(curves.size());
+        std::vector<BezierSegment> segs;
+        for (size_t i = 0; i < curves.size(); ++i) {
+            const CurveRecord& c = curves[i];
+            segs.clear();
+            for (uint32_t k = 0; k < c.segmentCount; ++k) {
+                const SegmentRecord& r = segments[c.firstSegment + k];
+                BezierSegment b;
+                std::memcpy(b.x, r.x, sizeof(b.x));
+                std::memcpy(b.y, r.y, sizeof(b.y));
+                b.weight = r.weight;
+                segs.push_back(b);
+            }
+            compiled[i] = Trajectory::compile(segs.data(), int(segs.size()),
+                                              c.samples ? int(c.samples) : Trajectory::kDefaultSamples);
+        }
+    }
+};
+
+// -------- Hand-off to the motion thread --------
+// The loader offers a profile; the motion thread takes it at a tick boundary and gives back the
+// one it replaced. Nothing here blocks or frees memory on the motion thread: retired profiles are
+// freed by the loader on its next offer (or by the destructor).
+class ProfileHandoff {
+public:
+    ProfileHandoff() = default;
+    ProfileHandoff(const ProfileHandoff&) = delete;
+    ProfileHandoff& operator=(const ProfileHandoff&) = delete;
+    ~ProfileHandoff() {
+        delete pending.exchange(nullptr, std::memory_order_acquire);
+        collect();
+    }
+
+    // Loader side.
+    void offer(std::unique_ptr<Profile> p) {
+        collect();
+        delete pending.exchange(p.release(), std::memory_order_acq_rel); // superseded before it was taken
+    }
+
+    // Motion thread: relaxed peek first so the common case is a plain load.
+    Profile* take() {
+        if (!pending.load(std::memory_order_relaxed)) return nullptr;
+        return pending.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    // Motion thread: lock-free push of the profile it stopped using.
+    void retire(Profile* old) {
+        if (!old) return;
+        Profile* head = retired.load(std::memory_order_relaxed);
+        do old->retiredNext = head;
+        while (!retired.compare_exchange_weak(head, old, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Loader side; also safe to call from shutdown once the motion thread has stopped.
+    void collect() {
+        Profile* p = retired.exchange(nullptr, std::memory_order_acquire);
+        while (p) {
+            Profile* next = p->retiredNext;
+            delete p;
+            p = next;
+        }
+    }
+
+private:
+    std::atomic<Profile*> pending{nullptr};
+    std::atomic<Profile*> retired{nullptr};
+};
+
+} // namespace redmouse
@@ -0,0 +1,312 @@
+// Reactor.h — single event-driven input thread (LL hooks on Windows, evdev+epoll on Linux)
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Clock.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#endif
+
+namespace redmouse {
+
+enum class Key : uint8_t {
+    LButton,
+    F1, F2, F3, F4, F5, F6, F7, F8, F9, F10,
+    Add, Subtract, Escape,
+    Count
+};
+
+struct InputEvent {
+    Key     key;
+    bool    down;
+    int64_t tNs; // steady_clock time the edge was observed
+};
+
+// Blocks on real input events; never polls, and has no timers of its own (tick timing belongs to
+// the scheduler). Handlers run on the reactor thread, outside any OS hook callback, so they may take
+// locks but should stay short.
+class Reactor {
+public:
+    using InputHandler = std::function<void(const InputEvent&)>;
+
+    explicit Reactor(InputHandler h) : handler(std::move(h)) {}
+    ~Reactor() { stop(); }
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    bool start() {
+        if (th.joinable()) return true;
+        running.store(true);
+        std::unique_lock<std::mutex> lk(mx);
+        startState = 0;
+        th = std::thread(&Reactor::threadMain, this);
+        startCv.wait(lk, [&] { return startState != 0; });
+        if (startState < 0) { lk.unlock(); th.join(); return false; }
+        return true;
+    }
+
+    // Not callable from a handler (would self-join); flip a flag and let the owner stop instead.
+    void stop() {
+        if (!th.joinable()) return;
+        running.store(false);
+        wake();
+        th.join();
+    }
+
+    bool isDown(Key k) const {
+        return (downBits.load(std::memory_order_acquire) >> unsigned(k)) & 1u;
+    }
+
+    // Synthetic edge (the mock device in tools/ReactorBench.cpp); delivered on the reactor thread
+    // through the same wake-up a device event takes.
+    void inject(Key k, bool down) {
+        {
+            std::lock_guard<std::mutex> lk(mx);
+            injected.push_back(InputEvent{ k, down, steadyNowNs() });
+        }
+        wake();
+    }
+
+    // Times the thread returned from its blocking wait; flat while nothing happens.
+    uint64_t wakeups() const { return wakeCount.load(std::memory_order_relaxed); }
+    // Input sources opened by start(): hooks on Windows, evdev nodes on Linux.
+    int deviceCount() const { return devices; }
+
+private:
+    InputHandler handler;
+    std::thread th;
+    std::atomic<bool> running{false};
+    std::atomic<uint32_t> downBits{0};
+    std::atomic<uint64_t> wakeCount{0};
+    int devices = 0;
+
+    std::mutex mx;
+    std::condition_variable startCv;
+    int startState = 0; // 0 pending, 1 running, -1 failed
+    std::vector<InputEvent> injected;
+
+    void signalStarted(bool ok) {
+        std::lock_guard<std::mutex> lk(mx);
+        startState = ok ? 1 : -1;
+        startCv.notify_all();
+    }
+
+    // Drops autorepeat and duplicate edges so handlers only see real transitions.
+    void deliver(Key k, bool down, int64_t tNs) {
+        const uint32_t bit = 1u << unsigned(k);
+        const uint32_t cur = downBits.load(std::memory_order_relaxed);
+        if (((cur & bit) != 0) == down) return;
+        downBits.store(down ? (cur | bit) : (cur & ~bit), std::memory_order_release);
+        if (handler) handler(InputEvent{ k, down, tNs });
+    }
+
+    void drainInjected() {
+        std::vector<InputEvent> batch;
+        {
+            std::lock_guard<std::mutex> lk(mx);
+            if (injected.empty()) return;
+            batch.swap(injected);
+        }
+        for (const InputEvent& e : batch) deliver(e.key, e.down, e.tNs);
+    }
+
+#ifdef _WIN32
+    // -------- Windows: WH_KEYBOARD_LL / WH_MOUSE_LL on a dedicated message loop --------
+    static constexpr UINT WM_REACTOR_WAKE = WM_APP + 0x52;
+    std::atomic<DWORD> threadId{0};
+    std::vector<InputEvent> hookQueue; // touched only on the reactor thread
+
+    static Reactor*& hookOwner() { static Reactor* r = nullptr; return r; }
+
+    static bool mapVk(DWORD vk, Key& k) {
+        if (vk >= VK_F1 && vk <= VK_F10) { k = Key(unsigned(Key::F1) + (vk - VK_F1)); return true; }
+        switch (vk) {
+        case VK_ADD:      k = Key::Add;      return true;
+        case VK_SUBTRACT: k = Key::Subtract; return true;
+        case VK_ESCAPE:   k = Key::Escape;   return true;
+        }
+        return false;
+    }
+
+    // Hook procs only enqueue; anything slow here risks the OS silently unhooking us.
+    static LRESULT CALLBACK keyboardHook(int code, WPARAM wParam, LPARAM lParam) {
+        Reactor* self = hookOwner();
+        if (code == HC_ACTION && self) {
+            auto* k = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+            Key key;
+            if (mapVk(k->vkCode, key)) {
+                const bool down = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+                self->hookQueue.push_back(InputEvent{ key, down, steadyNowNs() });
+            }
+        }
+        return CallNextHookEx(nullptr, code, wParam, lParam);
+    }
+
+    static LRESULT CALLBACK mouseHook(int code, WPARAM wParam, LPARAM lParam) {
+        Reactor* self = hookOwner();
+        if (code == HC_ACTION && self && (wParam == WM_LBUTTONDOWN || wParam == WM_LBUTTONUP))
+            self->hookQueue.push_back(InputEvent{ Key::LButton, wParam == WM_LBUTTONDOWN, steadyNowNs() });
+        return CallNextHookEx(nullptr, code, wParam, lParam);
+    }
+
+    void wake() {
+        if (DWORD id = threadId.load()) PostThreadMessageW(id, WM_REACTOR_WAKE, 0, 0);
+    }
+
+    void threadMain() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+        MSG msg;
+        PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE); // force a message queue
+        threadId.store(GetCurrentThreadId());
+        hookQueue.reserve(64);
+
+        hookOwner() = this;
+        HMODULE mod = GetModuleHandleW(nullptr);
+        HHOOK kb = SetWindowsHookExW(WH_KEYBOARD_LL, keyboardHook, mod, 0);
+        HHOOK ms = SetWindowsHookExW(WH_MOUSE_LL,    mouseHook,    mod, 0);
+        devices = (kb ? 1 : 0) + (ms ? 1 : 0);
+        const bool ok = kb && ms;
+        signalStarted(ok);
+
+        while (ok && running.load()) {
+            while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                if (msg.message == WM_QUIT) running.store(false);
+                TranslateMessage(&msg);
+                DispatchMessageW(&msg);
+            }
+            for (const InputEvent& e : hookQueue) deliver(e.key, e.down, e.tNs);
+            hookQueue.clear();
+            drainInjected();
+            if (!running.load()) break;
+            MsgWaitForMultipleObjectsEx(0, nullptr, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+            wakeCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (kb) UnhookWindowsHookEx(kb);
+        if (ms) UnhookWindowsHookEx(ms);
+        hookOwner() = nullptr;
+        threadId.store(0);
+    }
+#elif defined(__linux__)
+    // -------- Linux: evdev devices + eventfd behind one epoll --------
+    int epfd = -1, evfd = -1;
+    std::vector<int> devFds;
+
+    static bool mapCode(unsigned code, Key& k) {
+        if (code >= KEY_F1 && code <= KEY_F10) { k = Key(unsigned(Key::F1) + (code - KEY_F1)); return true; }
+        switch (code) {
+        case BTN_LEFT:    k = Key::LButton;  return true;
+        case KEY_KPPLUS:  k = Key::Add;      return true;
+        case KEY_KPMINUS: k = Key::Subtract; return true;
+        case KEY_ESC:     k = Key::Escape;   return true;
+        }
+        return false;
+    }
+
+    static bool testBit(const unsigned long* bits, unsigned n) {
+        const unsigned w = unsigned(sizeof(unsigned long) * 8);
+        return (bits[n / w] >> (n % w)) & 1ul;
+    }
+
+    // Opens every readable event node that reports F-keys or a left button.
+    void openDevices() {
+        DIR* d = opendir("/dev/input");
+        if (!d) return;
+        while (dirent* de = readdir(d)) {
+            if (std::strncmp(de->d_name, "event", 5) != 0) continue;
+            char path[300];
+            std::snprintf(path, sizeof(path), "/dev/input/%s", de->d_name);
+            const int fd = ::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) continue;
+            unsigned long keys[(KEY_MAX + 1) / (sizeof(unsigned long) * 8) + 1] = {};
+            if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0 ||
+                !(testBit(keys, KEY_F1) || testBit(keys, BTN_LEFT))) {
+                ::close(fd);
+                continue;
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+            devFds.push_back(fd);
+        }
+        closedir(d);
+        devices = int(devFds.size());
+    }
+
+    void wake() {
+        if (evfd >= 0) { uint64_t one = 1; (void)!::write(evfd, &one, sizeof(one)); }
+    }
+
+    void readDevice(int fd) {
+        input_event ev[32];
+        for (;;) {
+            const ssize_t n = ::read(fd, ev, sizeof(ev));
+            if (n <= 0) return;
+            for (size_t i = 0; i < size_t(n) / sizeof(input_event); ++i) {
+                Key k;
+                // value 2 is autorepeat
+                if (ev[i].type == EV_KEY && ev[i].value != 2 && mapCode(ev[i].code, k))
+                    deliver(k, ev[i].value != 0, steadyNowNs());
+            }
+        }
+    }
+
+    void threadMain() {
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        const bool ok = epfd >= 0 && evfd >= 0;
+        if (ok) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = evfd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, evfd, &ev);
+            openDevices();
+        }
+        signalStarted(ok);
+
+        epoll_event ready[16];
+        while (ok && running.load()) {
+            drainInjected();
+            if (!running.load()) break;
+            const int n = epoll_wait(epfd, ready, 16, -1);
+            wakeCount.fetch_add(1, std::memory_order_relaxed);
+            for (int i = 0; i < n; ++i) {
+                const int fd = ready[i].data.fd;
+                uint64_t drain;
+                if (fd == evfd) (void)!::read(fd, &drain, sizeof(drain));
+                else readDevice(fd);
+            }
+        }
+
+        for (int fd : devFds) ::close(fd);
+        devFds.clear();
+        if (evfd >= 0) ::close(evfd);
+        if (epfd >= 0) ::close(epfd);
+        evfd = epfd = -1;
+    }
+#endif
+};
+
+} // namespace redmouse
@@ -0,0 +1,209 @@
+// RealtimeThread.h — real-time setup for the motion thread: pinning, MMCSS/SCHED_FIFO, locked memory, self-check
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "Telemetry.h"
+#include "TickScheduler.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <avrt.h>   // link Avrt.lib
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(_MSC_VER)
+#define REDMOUSE_NOINLINE __declspec(noinline)
+#else
+#define REDMOUSE_NOINLINE __attribute__((noinline))
+#endif
+
+namespace redmouse {
+
+// -------- Allocation probe --------
+// Counts operator new calls per thread, so the motion loop can prove it never allocates.
+// Exactly one translation unit per program defines REDMOUSE_COUNT_ALLOCATIONS before including
+// this header; everywhere else threadAllocations() just stays 0.
+inline thread_local uint64_t tlsAllocations = 0;
+inline uint64_t threadAllocations() { return tlsAllocations; }
+
+struct RealtimeOptions {
+    int  cpu = -1;            // logical CPU to pin to, -1 = leave to the scheduler
+    bool elevate = false;     // MMCSS "Pro Audio" (Windows) / SCHED_FIFO (Linux)
+    int  fifoPriority = 80;   // Linux only
+    bool lockMemory = false;  // keep the working set resident and prefault the stack
+};
+
+// Applies the options to the calling thread for its lifetime; MMCSS registration is undone by the
+// destructor. Each step that fails (missing privilege, bad CPU index) is reported, never fatal.
+class RealtimeScope {
+public:
+    static constexpr size_t kPrefaultStackBytes = 256 * 1024;
+    static constexpr size_t kLockReserveBytes   = 16 * 1024 * 1024;
+
+    explicit RealtimeScope(const RealtimeOptions& o) : opts(o) {
+        if (o.cpu >= 0) pinned = pin(o.cpu);
+        if (o.elevate) elevated = elevate(o.fifoPriority);
+        if (o.lockMemory) locked = lock();
+        describeInto();
+    }
+    ~RealtimeScope() {
+#ifdef _WIN32
+        if (mmcss) AvRevertMmThreadCharacteristics(mmcss);
+#endif
+    }
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+
+    bool isPinned() const { return pinned; }
+    bool isElevated() const { return elevated; }
+    bool isLocked() const { return locked; }
+    const char* describe() const { return text; }
+
+private:
+    RealtimeOptions opts;
+    bool pinned = false, elevated = false, locked = false;
+    char text[160] = {};
+#ifdef _WIN32
+    HANDLE mmcss = nullptr;
+#endif
+
+    // Touches the next kPrefaultStackBytes of stack so later deep calls don't page-fault.
+    REDMOUSE_NOINLINE static bool prefaultStack(bool lockPages) {
+        volatile uint8_t buf[kPrefaultStackBytes];
+        for (size_t i = 0; i < sizeof(buf); i += 4096) buf[i] = 0;
+        buf[sizeof(buf) - 1] = 0;
+#ifdef _WIN32
+        return !lockPages || VirtualLock(const_cast<uint8_t*>(buf), sizeof(buf));
+#else
+        (void)lockPages;
+        return true;
+#endif
+    }
+
+#ifdef _WIN32
+    bool pin(int cpu) {
+        if (cpu >= int(sizeof(DWORD_PTR) * 8)) return false;
+        return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+    }
+    bool elevate(int) {
+        DWORD task = 0;
+        mmcss = AvSetMmThreadCharacteristicsW(L"Pro Audio", &task);
+        if (mmcss) AvSetMmThreadPriority(mmcss, AVRT_PRIORITY_HIGH);
+        return mmcss != nullptr;
+    }
+    bool lock() {
+        // VirtualLock is bounded by the minimum working set, so grow it first; the hard minimum
+        // also keeps the pages the loop already touched from being trimmed under memory pressure.
+        const HANDLE proc = GetCurrentProcess();
+        SIZE_T mn = 0, mx = 0;
+        if (!GetProcessWorkingSetSize(proc, &mn, &mx) ||
+            !SetProcessWorkingSetSizeEx(proc, mn + kLockReserveBytes, mx + kLockReserveBytes,
+                                        QUOTA_LIMITS_HARDWS_MIN_ENABLE))
+            return false;
+        return prefaultStack(true);
+    }
+#elif defined(__linux__)
+    bool pin(int cpu) {
+        if (cpu >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+    bool elevate(int priority) {
+        sched_param sp{};
+        sp.sched_priority = priority;
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0; // needs CAP_SYS_NICE / rtprio limit
+    }
+    bool lock() {
+        const bool ok = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+        prefaultStack(false);
+        return ok;
+    }
+#else
+    bool pin(int) { return false; }
+    bool elevate(int) { return false; }
+    bool lock() { return prefaultStack(false); }
+#endif
+
+    void describeInto() {
+        int n = 0;
+        auto add = [&](const char* s) {
+            if (n >= 0 && size_t(n) < sizeof(text)) n += std::snprintf(text + n, sizeof(text) - size_t(n), "%s%s", n ? ", " : "", s);
+        };
+        char cpu[32];
+        if (opts.cpu >= 0) {
+            std::snprintf(cpu, sizeof(cpu), "cpu %d%s", opts.cpu, pinned ? "" : " (failed)");
+            add(cpu);
+        }
+#ifdef _WIN32
+        if (opts.elevate) add(elevated ? "MMCSS Pro Audio" : "MMCSS (failed)");
+#else
+        if (opts.elevate) add(elevated ? "SCHED_FIFO" : "SCHED_FIFO (failed)");
+#endif
+        if (opts.lockMemory) add(locked ? "memory locked" : "memory lock (failed)");
+        if (!n) add("default scheduling");
+    }
+};
+
+// -------- Startup self-check --------
+// Runs the scheduler for durationNs without emitting anything and reports how late the wake-ups
+// were and whether the wait path allocated. Call on the configured thread before the real loop.
+struct SelfCheckResult {
+    uint64_t ticks = 0, missed = 0;
+    uint64_t p50Ns = 0, p99Ns = 0, maxNs = 0;
+    uint64_t allocations = 0;
+};
+
+template <class Clock>
+SelfCheckResult tickSelfCheck(TickScheduler<Clock>& scheduler, int64_t durationNs) {
+    LogHistogram late; // 8 KB on the stack; nothing on the heap
+    SelfCheckResult r;
+    scheduler.reset();
+    const uint64_t allocBase = threadAllocations();
+    const int64_t end = scheduler.clock().nowNs() + durationNs;
+    while (scheduler.clock().nowNs() < end) {
+        const Tick t = scheduler.wait();
+        late.record(uint64_t(t.actualNs > t.scheduledNs ? t.actualNs - t.scheduledNs : 0));
+        r.missed += t.missed;
+        ++r.ticks;
+    }
+    r.allocations = threadAllocations() - allocBase;
+    r.p50Ns = late.percentile(0.50);
+    r.p99Ns = late.percentile(0.99);
+    r.maxNs = late.maxValue();
+    scheduler.reset();
+    return r;
+}
+
+} // namespace redmouse
+
+#ifdef REDMOUSE_COUNT_ALLOCATIONS
+void* operator new(std::size_t n) {
+    ++redmouse::tlsAllocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    ++redmouse::tlsAllocations;
+    return std::malloc(n ? n : 1);
+}
+void* operator new[](std::size_t n, const std::nothrow_t& t) noexcept { return ::operator new(n, t); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,376 @@
+// SessionLog.h — compact binary capture of a session (input edges, settings, ticks, moves) for offline replay
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MotionIntegrator.h"
+#include "Reactor.h"
+#include "Settings.h"
+#include "SpscRing.h"
+#include "TickScheduler.h"
+
+namespace redmouse {
+
+// -------- Stream layout --------
+//   SessionHeader | record*
+// Every record is a tag byte (kind in the low nibble, flags above it), then (except Tick) the time
+// since the previous record as a zigzag varint, then a kind-specific payload:
+//   Input     key byte                                    flag: down
+//   Settings  sensitivity (8 raw bytes), curve zigzag     flags: enabled, curve pattern
+//   Resume    -                                           (gate opened; integrator restarted per header startPolicy)
+//   Tick      [period varint], scheduled zigzag, lateness zigzag, missed varint, dy zigzag
+//             scheduled is relative to the previous tick's deadline + period (0 on a steady grid),
+//             lateness is actual - scheduled; flag: new period (tick rate changed)
+//   Move      dx zigzag, dy zigzag                        (sink delta when it differs from the tick's dy)
+//   Gap       records lost varint                         (ring overflow while recording)
+// A 1 kHz session costs about 7 bytes per tick, most of it the ns lateness.
+
+inline constexpr char     kSessionMagic[4] = { 'R', 'M', 'S', 'L' };
+inline constexpr uint16_t kSessionVersion  = 1;
+
+enum class SessionIntegrator : uint8_t { Fixed, Clamped, FixedPoint };
+
+struct SessionHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t rateHz;
+    uint8_t  integrator;   // SessionIntegrator
+    uint8_t  eventEmit;    // 1 = --emit=event
+    uint8_t  startPolicy;  // StartPolicy at press; 0 (Zero) in files written before it existed
+    uint8_t  reserved;
+    int64_t  startNs;      // steady clock at start(); the first record's delta is against it
+};
+static_assert(sizeof(SessionHeader) == 24, "session header is fixed-size");
+
+enum class SessionKind : uint8_t { Input = 1, Settings, Resume, Tick, Move, Gap };
+
+enum : uint8_t {
+    kSessionDown         = 1, // Input
+    kSessionEnabled      = 1, // Settings
+    kSessionCurvePattern = 2,
+    kSessionNewPeriod    = 1, // Tick
+};
+
+// One decoded record; also the fixed-size slot the hot path pushes.
+struct SessionRecord {
+    int64_t     tNs;
+    int64_t     scheduledNs; // Tick
+    int64_t     periodNs;    // Tick
+    double      sensitivity; // Settings
+    int32_t     dx, dy;      // Tick: integrator output (dy); Move: sink delta
+    int32_t     curve;       // Settings
+    uint32_t    count;       // Tick: missed; Gap: records lost
+    SessionKind kind;
+    Key         key;         // Input
+    uint8_t     flags;
+};
+
+// -------- Varint helpers --------
+inline uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+inline uint8_t* putVarint(uint8_t* p, uint64_t v) {
+    while (v >= 0x80) { *p++ = uint8_t(v) | 0x80; v >>= 7; }
+    *p++ = uint8_t(v);
+    return p;
+}
+
+inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t b = *p++;
+        v |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// -------- Recorder --------
+// Hot-path calls copy one SessionRecord into a preallocated ring and return; a background thread
+// encodes and writes. The reactor thread and the motion thread each own a ring, so both stay
+// single-producer. Records that don't fit are dropped and show up as a Gap record.
+class SessionRecorder {
+public:
+    explicit SessionRecorder(size_t ringCapacity = 16384) : inputRing(kInputCapacity), motionRing(ringCapacity) {}
+    ~SessionRecorder() { stop(); }
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // Takes ownership of f (closed by stop()). startNs must come from the clock the records use.
+    bool start(std::FILE* f, uint32_t rateHz, SessionIntegrator integ, bool eventEmit, int64_t startNs,
+               StartPolicy policy = StartPolicy::Zero) {
+        if (worker.joinable() || !f) return false;
+        SessionHeader h{};
+        std::memcpy(h.magic, kSessionMagic, 4);
+        h.version = kSessionVersion;
+        h.headerSize = uint16_t(sizeof(SessionHeader));
+        h.rateHz = rateHz;
+        h.integrator = uint8_t(integ);
+        h.eventEmit = eventEmit ? 1 : 0;
+        h.startPolicy = uint8_t(policy);
+        h.startNs = startNs;
+        if (std::fwrite(&h, sizeof(h), 1, f) != 1) { std::fclose(f); return false; }
+        // Writer-side buffers are only allocated when recording is actually requested.
+        inputScratch.resize(inputRing.capacity());
+        motionScratch.resize(motionRing.capacity());
+        out.resize((inputScratch.size() + motionScratch.size() + 1) * kMaxRecordBytes); // one batch of each + a Gap
+        file = f;
+        lastNs = lastScheduledNs = startNs;
+        lastPeriodNs = 0;
+        written = sizeof(h);
+        stopping = false;
+        worker = std::thread(&SessionRecorder::run, this);
+        on.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop() {
+        if (!worker.joinable()) return;
+        on.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lk(mx);
+            stopping = true;
+        }
+        cv.notify_all();
+        worker.join();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    bool active() const { return on.load(std::memory_order_relaxed); }
+
+    // Reactor thread.
+    void input(const InputEvent& e) {
+        if (!active()) return;
+        SessionRecord r{};
+        r.tNs = e.tNs; r.kind = SessionKind::Input; r.key = e.key; r.flags = e.down ? kSessionDown : 0;
+        inputRing.push(r);
+    }
+
+    // Motion thread.
+    void settings(int64_t tNs, const MotionSettings& s) {
+        if (!active()) return;
+        SessionRecord r{};
+        r.tNs = tNs; r.kind = SessionKind::Settings; r.sensitivity = s.sensitivity; r.curve = s.curve;
+        r.flags = uint8_t((s.enabled ? kSessionEnabled : 0) | (s.curvePattern ? kSessionCurvePattern : 0));
+        motionRing.push(r);
+    }
+    void resume(int64_t tNs) {
+        if (!active()) return;
+        SessionRecord r{};
+        r.tNs = tNs; r.kind = SessionKind::Resume;
+        motionRing.push(r);
+    }
+    void tick(const Tick& t, int32_t dy) {
+        if (!active()) return;
+        SessionRecord r{};
+        r.tNs = t.actualNs; r.scheduledNs = t.scheduledNs; r.periodNs = t.periodNs; r.count = t.missed; r.dy = dy;
+        r.kind = SessionKind::Tick;
+        motionRing.push(r);
+    }
+    void move(int64_t tNs, int32_t dx, int32_t dy) {
+        if (!active()) return;
+        SessionRecord r{};
+        r.tNs = tNs; r.dx = dx; r.dy = dy; r.kind = SessionKind::Move;
+        motionRing.push(r);
+    }
+
+    // Blocks until the writer has drained both rings. For producers that outrun real time
+    // (offline generators); the apps never call it.
+    void flush() {
+        {
+            std::lock_guard<std::mutex> lk(mx);
+            kick = true;
+        }
+        cv.notify_all();
+        while (worker.joinable() && (inputRing.sizeApprox() || motionRing.sizeApprox())) std::this_thread::yield();
+    }
+
+    uint64_t dropped() const { return inputRing.dropped() + motionRing.dropped(); }
+    uint64_t bytesWritten() const { return written.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kInputCapacity  = 1024;
+    static constexpr size_t kMaxRecordBytes = 1 + 5 * 10; // tag + five varints (a Tick with a new period)
+
+    SpscRing<SessionRecord> inputRing, motionRing;
+    std::vector<SessionRecord> inputScratch, motionScratch;
+    std::vector<uint8_t> out;
+    std::atomic<bool> on{false};
+    std::FILE* file = nullptr;
+    std::thread worker;
+    std::mutex mx;
+    std::condition_variable cv;
+    bool stopping = false, kick = false;
+    int64_t lastNs = 0, lastPeriodNs = 0, lastScheduledNs = 0;
+    uint64_t reportedDrops = 0;
+    std::atomic<uint64_t> written{0};
+
+    uint8_t* encode(uint8_t* p, const SessionRecord& r) {
+        uint8_t flags = r.flags;
+        if (r.kind == SessionKind::Tick && r.periodNs != lastPeriodNs) flags |= kSessionNewPeriod;
+        *p++ = uint8_t(uint8_t(r.kind) | (flags << 4));
+        if (r.kind != SessionKind::Tick) p = putVarint(p, zigzag(r.tNs - lastNs));
+        lastNs = r.tNs;
+        switch (r.kind) {
+        case SessionKind::Input:    *p++ = uint8_t(r.key); break;
+        case SessionKind::Settings:
+            std::memcpy(p, &r.sensitivity, 8); p += 8;
+            p = putVarint(p, zigzag(r.curve));
+            break;
+        case SessionKind::Resume:   break;
+        case SessionKind::Tick:
+            if (flags & kSessionNewPeriod) { p = putVarint(p, uint64_t(r.periodNs)); lastPeriodNs = r.periodNs; }
+            p = putVarint(p, zigzag(r.scheduledNs - (lastScheduledNs + lastPeriodNs)));
+            p = putVarint(p, zigzag(r.tNs - r.scheduledNs));
+            lastScheduledNs = r.scheduledNs;
+            p = putVarint(p, r.count);
+            p = putVarint(p, zigzag(r.dy));
+            break;
+        case SessionKind::Move:
+            p = putVarint(p, zigzag(r.dx));
+            p = putVarint(p, zigzag(r.dy));
+            break;
+        case SessionKind::Gap:      p = putVarint(p, r.count); break;
+        }
+        return p;
+    }
+
+    // Merges one batch from each ring by time, so the file stays ordered unless an input record
+    // sits in its ring for longer than a drain period.
+    void drain() {
+        const size_t ni = inputRing.popBatch(inputScratch.data(), inputScratch.size());
+        const size_t nm = motionRing.popBatch(motionScratch.data(), motionScratch.size());
+        uint8_t* p = out.data();
+        size_t i = 0, m = 0;
+        while (i < ni || m < nm) {
+            const bool takeInput = m == nm || (i < ni && inputScratch[i].tNs <= motionScratch[m].tNs);
+            p = encode(p, takeInput ? inputScratch[i++] : motionScratch[m++]);
+        }
+        const uint64_t drops = dropped();
+        if (drops != reportedDrops) {
+            SessionRecord g{};
+            g.tNs = lastNs; g.kind = SessionKind::Gap; g.count = uint32_t(drops - reportedDrops);
+            p = encode(p, g);
+            reportedDrops = drops;
+        }
+        const size_t n = size_t(p - out.data());
+        if (n && std::fwrite(out.data(), 1, n, file) == n) written.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void run() {
+        for (;;) {
+            bool quit;
+            {
+                std::unique_lock<std::mutex> lk(mx);
+                cv.wait_for(lk, std::chrono::milliseconds(50), [&] { return stopping || kick; });
+                quit = stopping;
+                kick = false;
+            }
+            while (inputRing.sizeApprox() || motionRing.sizeApprox()) drain();
+            if (dropped() != reportedDrops) drain();
+            if (quit) { std::fflush(file); return; }
+        }
+    }
+};
+
+// -------- Reader --------
+// Decodes a stream held in memory (typically a MappedFile) one record at a time.
+class SessionReader {
+public:
+    bool open(const uint8_t* data, size_t size, std::string* error = nullptr) {
+        if (size < sizeof(SessionHeader)) return fail(error, "session log too small");
+        std::memcpy(&hdr, data, sizeof(hdr));
+        if (std::memcmp(hdr.magic, kSessionMagic, 4) != 0) return fail(error, "not a RedMouse session log");
+        if (hdr.version != kSessionVersion || hdr.headerSize != sizeof(SessionHeader))
+            return fail(error, "unsupported session log version");
+        p = data + sizeof(SessionHeader);
+        end = data + size;
+        lastNs = lastScheduledNs = hdr.startNs;
+        lastPeriodNs = 0;
+        truncated = false;
+        return true;
+    }
+
+    const SessionHeader& header() const { return hdr; }
+
+    // False at the end of the stream; truncatedTail() tells a clean end from a cut-off record.
+    bool next(SessionRecord& r) {
+        if (p >= end) return false;
+        r = SessionRecord{};
+        const uint8_t tag = *p++;
+        r.kind = SessionKind(tag & 0x0f);
+        r.flags = uint8_t(tag >> 4);
+        uint64_t v = 0, a = 0, b = 0;
+        bool ok = r.kind == SessionKind::Tick || getVarint(p, end, v);
+        r.tNs = lastNs + unzigzag(v);
+        switch (r.kind) {
+        case SessionKind::Input:
+            ok = ok && p < end;
+            if (ok) r.key = Key(*p++);
+            break;
+        case SessionKind::Settings:
+            ok = ok && end - p >= 8;
+            if (ok) { std::memcpy(&r.sensitivity, p, 8); p += 8; }
+            ok = ok && getVarint(p, end, a);
+            r.curve = int32_t(unzigzag(a));
+            break;
+        case SessionKind::Resume:
+            break;
+        case SessionKind::Tick:
+            if (r.flags & kSessionNewPeriod) {
+                ok = ok && getVarint(p, end, a);
+                lastPeriodNs = int64_t(a);
+            }
+            r.periodNs = lastPeriodNs;
+            ok = ok && getVarint(p, end, a) && getVarint(p, end, b);
+            r.scheduledNs = lastScheduledNs + lastPeriodNs + unzigzag(a);
+            r.tNs = r.scheduledNs + unzigzag(b);
+            lastScheduledNs = r.scheduledNs;
+            ok = ok && getVarint(p, end, v) && getVarint(p, end, b);
+            r.count = uint32_t(v);
+            r.dy = int32_t(unzigzag(b));
+            break;
+        case SessionKind::Move:
+            ok = ok && getVarint(p, end, a) && getVarint(p, end, b);
+            r.dx = int32_t(unzigzag(a));
+            r.dy = int32_t(unzigzag(b));
+            break;
+        case SessionKind::Gap:
+            ok = ok && getVarint(p, end, v);
+            r.count = uint32_t(v);
+            break;
+        default:
+            ok = false;
+        }
+        if (!ok) { p = end; truncated = true; return false; }
+        lastNs = r.tNs;
+        return true;
+    }
+
+    bool truncatedTail() const { return truncated; }
+
+private:
+    SessionHeader hdr{};
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+    int64_t lastNs = 0, lastPeriodNs = 0, lastScheduledNs = 0;
+    bool truncated = false;
+
+    static bool fail(std::string* error, const char* why) {
+        if (error) *error = why;
+        return false;
+    }
+};
+
+} // namespace redmouse
@@ -0,0 +1,96 @@
+// Settings.h — versioned, tear-free settings snapshot shared by the UI/input threads and the motion thread
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "Clock.h"
+#include "Presets.h"
+
+namespace redmouse {
+
+// Everything the motion loop reads per tick. Plain data: it is copied word by word.
+struct MotionSettings {
+    double  sensitivity  = kDefaultSensitivity;
+    bool    enabled      = false;
+    bool    curvePattern = false;
+    int32_t curve        = -1; // profile curve used by Curve Pattern, -1 = built-in
+};
+
+// Seqlock over a trivially copyable T. Readers never block and never see a half-written T;
+// writers (UI, reactor, slider) serialise on the sequence word itself. The whole cell sits
+// on its own cache lines so UI-side fields next to it don't bounce the reader's line.
+template <class T>
+class alignas(64) Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock<T> copies T as raw words");
+    static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+public:
+    explicit Seqlock(const T& init = T{}) { store(init); }
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Motion thread: one acquire load on the fast path, re-validated after the copy.
+    T load() const {
+        T out;
+        uint64_t buf[kWords];
+        for (;;) {
+            const uint64_t s0 = seq.load(std::memory_order_acquire);
+            if (s0 & 1) { REDMOUSE_CPU_RELAX(); continue; }
+            for (size_t i = 0; i < kWords; ++i) buf[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s0) break;
+        }
+        std::memcpy(&out, buf, sizeof(T));
+        return out;
+    }
+
+    // Bumped once per publish; cheap "did anything change" check without copying.
+    uint64_t version() const { return seq.load(std::memory_order_acquire) >> 1; }
+
+    void store(const T& v) { update([&](T& cur) { cur = v; }); }
+
+    // Read-modify-write under the write lock, so concurrent toggles and +/- steps don't lose updates.
+    // Returns the published value.
+    template <class Fn>
+    T update(Fn&& fn) {
+        const uint64_t odd = lockWrite();
+        uint64_t buf[kWords] = {};
+        for (size_t i = 0; i < kWords; ++i) buf[i] = words[i].load(std::memory_order_relaxed);
+        T cur;
+        std::memcpy(&cur, buf, sizeof(T));
+        fn(cur);
+        std::memcpy(buf, &cur, sizeof(T));
+        for (size_t i = 0; i < kWords; ++i) words[i].store(buf[i], std::memory_order_relaxed);
+        seq.store(odd + 1, std::memory_order_release);
+        return cur;
+    }
+
+private:
+    std::atomic<uint64_t> seq{0}; // odd while a writer is inside
+    std::atomic<uint64_t> words[kWords]{};
+
+    uint64_t lockWrite() {
+        uint64_t s = seq.load(std::memory_order_relaxed);
+        for (;;) {
+            if (!(s & 1) && seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                                      std::memory_order_relaxed))
+                break;
+            REDMOUSE_CPU_RELAX();
+            s = seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release); // data stores stay after the odd seq
+        return s + 1;
+    }
+};
+
+// Numpad +/- and preset keys share these so both front-ends clamp the same way.
+inline double clampSensitivity(double v) {
+    return v < kMinSensitivity ? kMinSensitivity : (v > kMaxSensitivity ? kMaxSensitivity : v);
+}
+
+using SettingsCell = Seqlock<MotionSettings>;
+
+} // namespace redmouse
@@ -0,0 +1,97 @@
+// SpscRing.h — bounded wait-free single-producer/single-consumer ring
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace redmouse {
+
+// Storage is allocated once in the constructor; push/pop never allocate or block.
+// T should be trivially copyable. Capacity is rounded up to a power of two.
+template <class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        buf.reset(new T[n]);
+        mask = n - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only. Returns false (and counts a drop) when full.
+    bool push(const T& v) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache > mask) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache > mask) {
+                drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        buf[h & mask] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer only. Like push(), but fill(T&) writes the slot in place: no copy of a large T.
+    template <class Fn>
+    bool pushWith(Fn&& fill) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache > mask) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache > mask) {
+                drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        fill(buf[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool pop(T& out) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == headCache) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t == headCache) return false;
+        }
+        out = buf[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Copies up to max entries; returns how many.
+    size_t popBatch(T* out, size_t max) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        headCache = head.load(std::memory_order_acquire);
+        size_t n = headCache - t;
+        if (n > max) n = max;
+        for (size_t i = 0; i < n; ++i) out[i] = buf[(t + i) & mask];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t sizeApprox() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    uint64_t dropped() const { return drops.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<T[]> buf;
+    size_t mask = 0;
+
+    // Producer and consumer indices on separate cache lines, each with a private cache of the other side.
+    alignas(64) std::atomic<size_t> head{0};
+    size_t tailCache = 0;
+    std::atomic<uint64_t> drops{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t headCache = 0;
+};
+
+} // namespace redmouse
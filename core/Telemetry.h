@@ -0,0 +1,263 @@
+// Telemetry.h — per-tick records from the motion thread, aggregated off the hot path
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SpscRing.h"
+#include "TickScheduler.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace redmouse {
+
+struct TickRecord {
+    int64_t  scheduledNs;
+    int64_t  actualNs;
+    float    dt;        // seconds, as measured (before any clamp)
+    float    acc;       // accumulator after emission, pixels
+    int32_t  dy;        // pixels emitted this tick
+    uint32_t injectNs;  // time spent inside the sink call
+    uint8_t  flags;
+};
+
+// HDR-style log-linear histogram: 16 sub-buckets per power of two (<= 6.25% relative error), fixed storage.
+class LogHistogram {
+public:
+    static constexpr int SubBits = 4;
+    static constexpr int Sub     = 1 << SubBits;
+    static constexpr int Size    = (64 - SubBits + 1) * Sub;
+
+    void record(uint64_t v) {
+        ++counts[indexOf(v)];
+        ++total;
+        if (v > maxV) maxV = v;
+    }
+
+    void merge(const LogHistogram& o) {
+        for (int i = 0; i < Size; ++i) counts[i] += o.counts[i];
+        total += o.total;
+        if (o.maxV > maxV) maxV = o.maxV;
+    }
+
+    void reset() { std::memset(counts, 0, sizeof(counts)); total = 0; maxV = 0; }
+
+    // p in [0,1]; returns the bucket midpoint.
+    uint64_t percentile(double p) const {
+        if (!total) return 0;
+        uint64_t rank = uint64_t(p * double(total) + 0.5);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < Size; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                const uint64_t v = midpoint(i);
+                return v > maxV ? maxV : v;
+            }
+        }
+        return maxV;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t maxValue() const { return maxV; }
+
+private:
+    uint64_t counts[Size] = {};
+    uint64_t total = 0;
+    uint64_t maxV = 0;
+
+    static int msb(uint64_t v) {
+#ifdef _MSC_VER
+        unsigned long i;
+        _BitScanReverse64(&i, v);
+        return int(i);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+    static int indexOf(uint64_t v) {
+        if (v < uint64_t(Sub)) return int(v);
+        const int shift = msb(v) - SubBits;
+        return ((shift + 1) << SubBits) + int((v >> shift) & (Sub - 1));
+    }
+    static uint64_t midpoint(int i) {
+        if (i < Sub) return uint64_t(i);
+        const int shift = (i >> SubBits) - 1;
+        const uint64_t lo = uint64_t(Sub + (i & (Sub - 1))) << shift;
+        return lo + ((uint64_t(1) << shift) >> 1);
+    }
+};
+
+struct TelemetrySnapshot {
+    uint64_t ticks = 0, moves = 0, pixels = 0;
+    uint64_t dtClamps = 0, accClamps = 0, missedTicks = 0, dropped = 0;
+    int32_t  maxDy = 0;
+    uint64_t jitterP50 = 0, jitterP99 = 0, jitterP999 = 0, jitterMax = 0; // ns
+    uint64_t injectP50 = 0, injectP99 = 0, injectP999 = 0, injectMax = 0; // ns
+};
+
+// record() is the only hot-path call: one wait-free ring push, a fence and a flag check, no
+// allocation and no lock; the first record after an idle period also signals a WakeEvent. A
+// background thread drains the ring every 50 ms into histograms, optionally writing one CSV row per
+// interval and invoking a report callback for console/UI display. Once a round finds nothing new
+// and everything is written out, it parks with no timeout until the next record() or stop().
+class Telemetry {
+public:
+    struct Options {
+        std::FILE* csv = nullptr;       // owned; closed by stop()
+        uint32_t dumpIntervalMs = 1000;
+        uint32_t reportIntervalMs = 0;  // 0 disables onReport
+        std::function<void(const TelemetrySnapshot&)> onReport;
+    };
+
+    explicit Telemetry(size_t ringCapacity = 8192) : ring(ringCapacity), scratch(ringCapacity) {}
+    ~Telemetry() { stop(); }
+
+    void record(const TickRecord& r) {
+        ring.push(r);
+        // Pairs with the fence in run(): either the aggregator sees this record or this sees parked.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed)) wake.signal();
+    }
+
+    void start(Options o) {
+        if (worker.joinable()) return;
+        opts = std::move(o);
+        if (opts.csv)
+            std::fprintf(opts.csv, "t_s,ticks,moves,pixels,dt_clamps,acc_clamps,missed,dropped,"
+                                   "jitter_p50_us,jitter_p99_us,jitter_p999_us,jitter_max_us,"
+                                   "inject_p50_us,inject_p99_us,inject_p999_us,inject_max_us\n");
+        stopping.store(false, std::memory_order_relaxed);
+        wake.clear();
+        worker = std::thread(&Telemetry::run, this);
+    }
+
+    void stop() {
+        if (!worker.joinable()) return;
+        stopping.store(true, std::memory_order_seq_cst);
+        wake.signal();
+        worker.join();
+        if (opts.csv) { std::fclose(opts.csv); opts.csv = nullptr; }
+    }
+
+    // Cumulative since start. Any thread except the motion thread.
+    TelemetrySnapshot snapshot() const {
+        std::lock_guard<std::mutex> lk(mx);
+        return total;
+    }
+
+private:
+    struct Window {
+        TelemetrySnapshot s;
+        LogHistogram jitter, inject;
+        void reset() { s = TelemetrySnapshot(); jitter.reset(); inject.reset(); }
+        void finish(uint64_t droppedTotal) {
+            s.dropped   = droppedTotal;
+            s.jitterP50 = jitter.percentile(0.50); s.jitterP99 = jitter.percentile(0.99);
+            s.jitterP999 = jitter.percentile(0.999); s.jitterMax = jitter.maxValue();
+            s.injectP50 = inject.percentile(0.50); s.injectP99 = inject.percentile(0.99);
+            s.injectP999 = inject.percentile(0.999); s.injectMax = inject.maxValue();
+        }
+    };
+
+    SpscRing<TickRecord> ring;
+    std::vector<TickRecord> scratch;
+    Options opts;
+    std::thread worker;
+    mutable std::mutex mx; // aggregator vs snapshot(); never taken by record()
+    TelemetrySnapshot total;
+    std::atomic<bool> stopping{false};
+    alignas(64) std::atomic<bool> parked{false}; // read by record() on every tick
+    WakeEvent wake;                              // record() after parking, and stop()
+
+    static void add(Window& w, const TickRecord& r) {
+        ++w.s.ticks;
+        const int64_t late = r.actualNs - r.scheduledNs;
+        w.jitter.record(uint64_t(late > 0 ? late : 0));
+        if (r.dy) {
+            ++w.s.moves;
+            w.s.pixels += uint64_t(r.dy < 0 ? -r.dy : r.dy);
+            if (r.dy > w.s.maxDy) w.s.maxDy = r.dy;
+            w.inject.record(r.injectNs);
+        }
+        if (r.flags & TickDtClamped)  ++w.s.dtClamps;
+        if (r.flags & TickAccClamped) ++w.s.accClamps;
+        if (r.flags & TickMissed)     ++w.s.missedTicks;
+    }
+
+    void writeCsv(double tS, const TelemetrySnapshot& s) {
+        std::fprintf(opts.csv, "%.3f,%llu,%llu,%llu,%llu,%llu,%llu,%llu,"
+                               "%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+            tS, (unsigned long long)s.ticks, (unsigned long long)s.moves, (unsigned long long)s.pixels,
+            (unsigned long long)s.dtClamps, (unsigned long long)s.accClamps,
+            (unsigned long long)s.missedTicks, (unsigned long long)s.dropped,
+            s.jitterP50 / 1e3, s.jitterP99 / 1e3, s.jitterP999 / 1e3, s.jitterMax / 1e3,
+            s.injectP50 / 1e3, s.injectP99 / 1e3, s.injectP999 / 1e3, s.injectMax / 1e3);
+        std::fflush(opts.csv);
+    }
+
+    void run() {
+        Window all, win;
+        all.reset(); win.reset();
+        SteadyClock clock;
+        const int64_t drainNs = 50000000;
+        const int64_t dumpNs = int64_t(opts.dumpIntervalMs) * 1000000;
+        const int64_t reportNs = int64_t(opts.reportIntervalMs) * 1000000;
+        const bool reporting = opts.onReport && opts.reportIntervalMs;
+        const int64_t startNs = steadyNowNs();
+        int64_t lastDump = startNs, lastReport = startNs;
+        uint64_t reportedTicks = 0;
+
+        for (;;) {
+            clock.sleepUntil(clock.nowNs() + drainNs, 0, &wake);
+            const bool quit = stopping.load(std::memory_order_acquire);
+            if (!quit) wake.clear(); // a late signal from record() must not turn the next round into a spin
+            size_t n, got = 0;
+            while ((n = ring.popBatch(scratch.data(), scratch.size())) != 0) {
+                for (size_t i = 0; i < n; ++i) { add(all, scratch[i]); add(win, scratch[i]); }
+                got += n;
+            }
+
+            all.finish(ring.dropped());
+            {
+                std::lock_guard<std::mutex> lk(mx);
+                total = all.s;
+            }
+
+            const int64_t now = steadyNowNs();
+            if (opts.csv && (now - lastDump >= dumpNs || quit)) {
+                win.finish(ring.dropped());
+                if (win.s.ticks) writeCsv(double(now - startNs) * 1e-9, win.s);
+                win.reset();
+                lastDump = now;
+            }
+            if (reporting && now - lastReport >= reportNs) {
+                if (all.s.ticks != reportedTicks) opts.onReport(all.s); // stay quiet while idle
+                reportedTicks = all.s.ticks;
+                lastReport = now;
+            }
+            if (quit) return;
+
+            // Idle: nothing new, no CSV row or report outstanding. Park until record() or stop().
+            const bool pendingCsv = opts.csv && win.s.ticks;
+            const bool pendingReport = reporting && all.s.ticks != reportedTicks;
+            if (got == 0 && !pendingCsv && !pendingReport) {
+                wake.clear();
+                parked.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (ring.sizeApprox() == 0 && !stopping.load(std::memory_order_relaxed)) wake.wait();
+                parked.store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+} // namespace redmouse
@@ -0,0 +1,100 @@
+// TickScheduler.h — fixed-rate tick grid with hybrid sleep/spin and deterministic overrun handling
+#pragma once
+
+#include <cstdint>
+
+#include "Clock.h"
+
+namespace redmouse {
+
+enum class Overrun : uint8_t {
+    CatchUp, // late ticks fire back-to-back (up to maxCatchUp), then the rest are skipped
+    Skip     // jump straight to the next grid point; skipped ticks are reported in Tick::missed
+};
+
+// Per-tick conditions worth counting (carried in telemetry records).
+enum TickFlags : uint8_t {
+    TickDtClamped  = 1 << 0, // measured dt exceeded the clamp and was cut
+    TickAccClamped = 1 << 1, // accumulator hit its ceiling and distance was dropped
+    TickMissed     = 1 << 2, // scheduler skipped grid points before this tick
+};
+
+struct Tick {
+    uint64_t index;
+    int64_t  scheduledNs;
+    int64_t  actualNs;
+    uint32_t missed;      // grid points dropped before this tick
+    int64_t  periodNs;    // grid spacing this tick was scheduled on
+};
+
+// Deadlines are always start + n*period, so overruns never shift the phase of later ticks.
+template <class Clock>
+class TickScheduler {
+public:
+    struct Config {
+        uint32_t rateHz     = 1000;
+        int64_t  spinNs     = 50000;  // busy-wait tail before each deadline; 0 disables
+        Overrun  overrun    = Overrun::Skip;
+        uint32_t maxCatchUp = 4;
+    };
+
+    TickScheduler() : TickScheduler(Config{}) {}
+    explicit TickScheduler(const Config& c) : cfg(c) { setRate(c.rateHz); reset(); }
+
+    // Anchor the grid at "now" (e.g. when motion starts after being parked).
+    void reset() { next = clk.nowNs(); index = 0; }
+
+    void setRate(uint32_t hz) {
+        cfg.rateHz = hz < 1 ? 1 : hz;
+        period = 1000000000 / int64_t(cfg.rateHz);
+    }
+
+    Tick wait() {
+        int64_t now = clk.nowNs();
+        if (now < next) {
+            clk.sleepUntil(next, cfg.spinNs);
+            now = clk.nowNs();
+        }
+
+        Tick t{ index++, next, now, 0, period };
+        const int64_t late = now - next;
+        if (late >= period) {
+            const uint64_t behind = uint64_t(late / period);
+            if (cfg.overrun == Overrun::Skip || behind > cfg.maxCatchUp) {
+                next += int64_t(behind) * period;
+                t.missed = uint32_t(behind);
+            }
+            // CatchUp within budget: leave the grid alone and let the next wait() return at once.
+        }
+        next += period;
+        return t;
+    }
+
+    // Event-scheduled mode: one wake-up at an arbitrary deadline instead of the next grid point.
+    // Returns early (actualNs < scheduledNs) when wake is signalled, and clears it. The grid is
+    // re-anchored on the returned tick, so wait() can take over again afterwards.
+    Tick waitUntil(int64_t deadlineNs, WakeEvent* wake) {
+        int64_t now = clk.nowNs();
+        if (now < deadlineNs) {
+            clk.sleepUntil(deadlineNs, cfg.spinNs, wake);
+            now = clk.nowNs();
+        }
+        if (wake) wake->clear();
+        next = now + period;
+        return Tick{ index++, deadlineNs, now, 0, period };
+    }
+
+    int64_t periodNs() const { return period; }
+    int64_t nextDeadlineNs() const { return next; }
+    const Config& config() const { return cfg; }
+    Clock& clock() { return clk; }
+
+private:
+    Config  cfg;
+    Clock   clk;
+    int64_t period = 1000000;
+    int64_t next = 0;
+    uint64_t index = 0;
+};
+
+} // namespace redmouse
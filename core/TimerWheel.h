@@ -0,0 +1,103 @@
+// TimerWheel.h — hashed timer wheel over small integer ids (one pending deadline per id)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace redmouse {
+
+// Single-threaded. Each id sits in at most one slot, on an intrusive doubly linked list, so
+// schedule/cancel are O(1) and expire() only visits the slots time actually crossed.
+// Deadlines further out than the horizon (slots * slotNs) stay in their slot for extra rounds.
+class TimerWheel {
+public:
+    TimerWheel(size_t ids, int64_t slotNs, size_t slots, int64_t startNs)
+        : width(slotNs < 1 ? 1 : slotNs), nodes(ids) {
+        size_t n = 2;
+        while (n < slots) n <<= 1;
+        heads.assign(n, kNone);
+        mask = n - 1;
+        cursor = startNs / width;
+    }
+
+    // Replaces any pending deadline for id. Deadlines in the past fire on the next expire().
+    void schedule(uint32_t id, int64_t deadlineNs) {
+        cancel(id);
+        int64_t t = deadlineNs / width;
+        if (t < cursor) t = cursor;
+        Node& n = nodes[id];
+        n.deadline = deadlineNs;
+        n.slot = uint32_t(uint64_t(t) & mask);
+        n.prev = kNone;
+        n.next = heads[n.slot];
+        if (n.next != kNone) nodes[n.next].prev = id;
+        heads[n.slot] = id;
+        ++count;
+    }
+
+    void cancel(uint32_t id) {
+        Node& n = nodes[id];
+        if (n.slot == kNone) return;
+        if (n.prev != kNone) nodes[n.prev].next = n.next;
+        else heads[n.slot] = n.next;
+        if (n.next != kNone) nodes[n.next].prev = n.prev;
+        n.slot = kNone;
+        --count;
+    }
+
+    bool scheduled(uint32_t id) const { return nodes[id].slot != kNone; }
+    size_t size() const { return count; }
+
+    // Removes every id whose deadline is <= nowNs and calls fn(id, deadlineNs) for it.
+    template <class Fn>
+    void expire(int64_t nowNs, Fn&& fn) {
+        const int64_t now = nowNs / width;
+        // Past a full turn every slot has been visited once; the remainder is just more rounds.
+        if (now - cursor > int64_t(mask)) cursor = now - int64_t(mask);
+        for (;;) {
+            uint32_t id = heads[uint64_t(cursor) & mask];
+            while (id != kNone) {
+                const uint32_t next = nodes[id].next;
+                const int64_t d = nodes[id].deadline;
+                if (d <= nowNs) { cancel(id); fn(id, d); }
+                id = next;
+            }
+            if (cursor >= now || count == 0) break;
+            ++cursor;
+        }
+        if (cursor < now) cursor = now;
+    }
+
+    // Earliest pending deadline within one turn of the wheel, else the end of that turn
+    // (a later-round entry is re-checked then). INT64_MAX when empty.
+    int64_t nextDeadlineNs() const {
+        if (!count) return INT64_MAX;
+        for (int64_t t = cursor; t <= cursor + int64_t(mask); ++t) {
+            const int64_t end = (t + 1) * width;
+            int64_t best = INT64_MAX;
+            for (uint32_t id = heads[uint64_t(t) & mask]; id != kNone; id = nodes[id].next)
+                if (nodes[id].deadline < end && nodes[id].deadline < best) best = nodes[id].deadline;
+            if (best != INT64_MAX) return best;
+        }
+        return (cursor + int64_t(mask) + 1) * width;
+    }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Node {
+        int64_t  deadline = 0;
+        uint32_t slot = kNone;
+        uint32_t prev = kNone, next = kNone;
+    };
+
+    int64_t width;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> heads;
+    uint64_t mask = 0;
+    int64_t cursor = 0;
+    size_t count = 0;
+};
+
+} // namespace redmouse
@@ -0,0 +1,227 @@
+// Trajectory.h — curves compiled to piecewise cubics, baked into a LUT, streamed as relative deltas per tick
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REDMOUSE_TRAJECTORY_SSE2 1
+#endif
+
+namespace redmouse {
+
+// One cubic Bezier piece in pixels relative to the stroke start. weight = share of the stroke's duration.
+struct BezierSegment {
+    float x[4], y[4];
+    float weight;
+
+    static BezierSegment cubic(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3,
+                               float weight = 1.0f) {
+        return BezierSegment{ { x0, x1, x2, x3 }, { y0, y1, y2, y3 }, weight };
+    }
+    // Degree-elevated quadratic.
+    static BezierSegment quadratic(float x0, float y0, float cx, float cy, float x1, float y1, float weight = 1.0f) {
+        return cubic(x0, y0, x0 + 2.0f / 3.0f * (cx - x0), y0 + 2.0f / 3.0f * (cy - y0),
+                     x1 + 2.0f / 3.0f * (cx - x1), y1 + 2.0f / 3.0f * (cy - y1), x1, y1, weight);
+    }
+};
+
+// A stroke's shape offset over u in [0,1]. compile() turns Bezier pieces into power-basis
+// coefficients; bake() evaluates them (4 samples per SSE2 op) into a LUT so playback is a lerp.
+class Trajectory {
+public:
+    static constexpr int kDefaultSamples = 64;
+
+    static Trajectory compile(const BezierSegment* segs, int n, int samples = kDefaultSamples) {
+        Trajectory t;
+        float total = 0.0f;
+        for (int i = 0; i < n; ++i) total += segs[i].weight > 0.0f ? segs[i].weight : 0.0f;
+        float u0 = 0.0f;
+        for (int i = 0; i < n && total > 0.0f; ++i) {
+            if (segs[i].weight <= 0.0f) continue;
+            Piece p;
+            p.u0 = u0;
+            p.u1 = (i == n - 1) ? 1.0f : u0 + segs[i].weight / total;
+            toPower(segs[i].x, p.ax);
+            toPower(segs[i].y, p.ay);
+            t.pieces.push_back(p);
+            u0 = p.u1;
+        }
+        if (!t.pieces.empty()) t.pieces.back().u1 = 1.0f;
+        t.bake(samples);
+        return t;
+    }
+
+    // MouseRed's original curve: B(start, start+(0,m/2-5), start+(0,m)) = m*u - 10*u*(1-u).
+    // The m*u ramp is the stroke's own distance; what remains is a fixed 2.5 px "bob".
+    static Trajectory legacyBob() {
+        const BezierSegment s = BezierSegment::quadratic(0, 0, 0, -5, 0, 0);
+        return compile(&s, 1);
+    }
+
+    bool empty() const { return pieces.empty(); }
+    int samples() const { return int(lutX.size()) - 1; }
+
+    // Direct evaluation (baking, tests); playback uses at().
+    void eval(float u, float& x, float& y) const {
+        const Piece& p = pieceFor(u);
+        const float s = (u - p.u0) / (p.u1 - p.u0);
+        x = horner(p.ax, s);
+        y = horner(p.ay, s);
+    }
+
+    // LUT lookup with linear interpolation; u is clamped to [0,1].
+    void at(float u, float& x, float& y) const {
+        if (pieces.empty()) { x = y = 0.0f; return; }
+        const int n = samples();
+        float f = u * float(n);
+        if (f <= 0.0f) f = 0.0f;
+        if (f >= float(n)) { x = lutX[n]; y = lutY[n]; return; }
+        const int i = int(f);
+        const float w = f - float(i);
+        x = lutX[i] + (lutX[i + 1] - lutX[i]) * w;
+        y = lutY[i] + (lutY[i + 1] - lutY[i]) * w;
+    }
+
+private:
+    struct Piece {
+        float u0, u1;
+        float ax[4], ay[4]; // c0 + c1 s + c2 s^2 + c3 s^3
+    };
+    std::vector<Piece> pieces;
+    std::vector<float> lutX, lutY;
+
+    static void toPower(const float p[4], float c[4]) {
+        c[0] = p[0];
+        c[1] = 3.0f * (p[1] - p[0]);
+        c[2] = 3.0f * (p[0] - 2.0f * p[1] + p[2]);
+        c[3] = -p[0] + 3.0f * p[1] - 3.0f * p[2] + p[3];
+    }
+    static float horner(const float c[4], float s) { return ((c[3] * s + c[2]) * s + c[1]) * s + c[0]; }
+
+    const Piece& pieceFor(float u) const {
+        for (const Piece& p : pieces)
+            if (u < p.u1) return p;
+        return pieces.back();
+    }
+
+    // Evaluates samples [k0, k1) of one piece; four lanes at a time when SSE2 is available.
+    void bakePiece(const Piece& p, int k0, int k1, float invN) {
+        const float scale = 1.0f / (p.u1 - p.u0);
+        int k = k0;
+#ifdef REDMOUSE_TRAJECTORY_SSE2
+        const __m128 ax0 = _mm_set1_ps(p.ax[0]), ax1 = _mm_set1_ps(p.ax[1]), ax2 = _mm_set1_ps(p.ax[2]), ax3 = _mm_set1_ps(p.ax[3]);
+        const __m128 ay0 = _mm_set1_ps(p.ay[0]), ay1 = _mm_set1_ps(p.ay[1]), ay2 = _mm_set1_ps(p.ay[2]), ay3 = _mm_set1_ps(p.ay[3]);
+        const __m128 vScale = _mm_set1_ps(scale), vU0 = _mm_set1_ps(p.u0), vInvN = _mm_set1_ps(invN);
+        for (; k + 4 <= k1; k += 4) {
+            const __m128 kk = _mm_cvtepi32_ps(_mm_setr_epi32(k, k + 1, k + 2, k + 3));
+            const __m128 s  = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(kk, vInvN), vU0), vScale);
+            __m128 x = _mm_add_ps(_mm_mul_ps(ax3, s), ax2);
+            x = _mm_add_ps(_mm_mul_ps(x, s), ax1);
+            x = _mm_add_ps(_mm_mul_ps(x, s), ax0);
+            __m128 y = _mm_add_ps(_mm_mul_ps(ay3, s), ay2);
+            y = _mm_add_ps(_mm_mul_ps(y, s), ay1);
+            y = _mm_add_ps(_mm_mul_ps(y, s), ay0);
+            _mm_storeu_ps(&lutX[k], x);
+            _mm_storeu_ps(&lutY[k], y);
+        }
+#endif
+        for (; k < k1; ++k) {
+            const float s = (float(k) * invN - p.u0) * scale;
+            lutX[k] = horner(p.ax, s);
+            lutY[k] = horner(p.ay, s);
+        }
+    }
+
+    void bake(int n) {
+        if (n < 1) n = 1;
+        lutX.assign(size_t(n) + 1, 0.0f);
+        lutY.assign(size_t(n) + 1, 0.0f);
+        if (pieces.empty()) return;
+        const float invN = 1.0f / float(n);
+        int k = 0;
+        for (const Piece& p : pieces) {
+            int k1 = int(std::ceil(p.u1 * float(n) - 1e-4f));
+            if (&p == &pieces.back()) k1 = n + 1;
+            if (k1 > n + 1) k1 = n + 1;
+            if (k1 > k) bakePiece(p, k, k1, invN);
+            if (k1 > k) k = k1;
+        }
+    }
+};
+
+// Plays strokes against the tick clock. Each stroke carries dy pixels, spread linearly over its
+// duration, plus the trajectory's shape offset. Overlapping strokes are summed. advance() only
+// reads the LUT and returns the whole-pixel delta since the previous call, so it never sleeps.
+class CurvePlayer {
+public:
+    static constexpr int kMaxStrokes = 16;
+
+    CurvePlayer(const Trajectory* shape, int64_t strokeNs) : traj(shape), durationNs(strokeNs) {}
+
+    // Only switch between strokes (after finish()); in-flight strokes would jump to the new shape.
+    void setTrajectory(const Trajectory* shape) { traj = shape; }
+    void setStrokeNs(int64_t strokeNs) { durationNs = strokeNs; }
+    const Trajectory* trajectory() const { return traj; }
+
+    void start(int64_t nowNs, int dx, int dy) {
+        if (count == kMaxStrokes) retire(0);
+        strokes[count++] = Stroke{ nowNs, float(dx), float(dy) };
+    }
+
+    bool active() const { return count > 0; }
+
+    // Whole-pixel delta to emit at nowNs (sub-pixel remainder is carried).
+    void advance(int64_t nowNs, int& dx, int& dy) {
+        // All strokes share one duration, so they finish oldest-first.
+        while (count && nowNs - strokes[0].startNs >= durationNs) retire(0);
+        double px = baseX, py = baseY;
+        for (int i = 0; i < count; ++i) {
+            const float u = float(double(nowNs - strokes[i].startNs) / double(durationNs));
+            float sx, sy;
+            traj->at(u, sx, sy);
+            px += double(strokes[i].dx) * u + sx;
+            py += double(strokes[i].dy) * u + sy;
+        }
+        emitTo(px, py, dx, dy);
+    }
+
+    // Completes every stroke at once (button released, curve mode switched off).
+    void finish(int& dx, int& dy) {
+        while (count) retire(0);
+        emitTo(baseX, baseY, dx, dy);
+    }
+
+    void reset() { count = 0; baseX = baseY = 0.0; sentX = sentY = 0; }
+
+private:
+    struct Stroke { int64_t startNs; float dx, dy; };
+
+    const Trajectory* traj;
+    int64_t durationNs;
+    Stroke  strokes[kMaxStrokes];
+    int     count = 0;
+    double  baseX = 0.0, baseY = 0.0;  // end points of retired strokes
+    int64_t sentX = 0, sentY = 0;      // pixels already emitted
+
+    void retire(int i) {
+        float ex, ey;
+        traj->at(1.0f, ex, ey);
+        baseX += double(strokes[i].dx) + ex;
+        baseY += double(strokes[i].dy) + ey;
+        for (int j = i + 1; j < count; ++j) strokes[j - 1] = strokes[j];
+        --count;
+    }
+
+    void emitTo(double px, double py, int& dx, int& dy) {
+        const int64_t tx = int64_t(std::llround(px)), ty = int64_t(std::llround(py));
+        dx = int(tx - sentX);
+        dy = int(ty - sentY);
+        sentX = tx;
+        sentY = ty;
+    }
+};
+
+} // namespace redmouse
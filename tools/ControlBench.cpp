@@ -0,0 +1,130 @@
+// ControlBench.cpp — throughput and latency of core/ControlPlane.h: mailbox commands/s, round trips, status reads
+//   g++ -std=c++17 -O2 -pthread tools/ControlBench.cpp -o ControlBench      (Linux)
+//   cl /EHsc /std:c++17 tools\ControlBench.cpp                              (Windows)
+//   ControlBench [--clients=<n>] [--commands=<n>] [--rtt=<n>] [--reads=<n>] [--poll-us=<us>] [--max-rtt-us=<us>]
+// Each client thread maps the segment on its own, exactly as a separate process would, and pushes
+// sensitivity commands into the owner's mailbox. The owner applies them to a settings cell on its
+// service thread. --poll-us is the owner's idle backoff ceiling: 0 (the default here) spins, and the
+// controllers' default of 250000 shows the latency an idle controller adds.
+// Exit status is 1 when the round-trip p99 passes --max-rtt-us.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../core/ControlPlane.h"
+
+using namespace redmouse;
+
+static double percentileUs(std::vector<int64_t>& v, double q) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return double(v[std::min(v.size() - 1, size_t(q * double(v.size())))]) / 1e3;
+}
+
+int main(int argc, char** argv) {
+    unsigned clients = 2, pollUs = 0;
+    uint64_t commands = 200000, rtt = 2000, reads = 1000000;
+    double maxRttUs = -1;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strncmp(a, "--clients=", 10) == 0) clients = unsigned(std::max(1, std::atoi(a + 10)));
+        else if (std::strncmp(a, "--commands=", 11) == 0) commands = uint64_t(std::max(1, std::atoi(a + 11)));
+        else if (std::strncmp(a, "--rtt=", 6) == 0) rtt = uint64_t(std::max(0, std::atoi(a + 6)));
+        else if (std::strncmp(a, "--reads=", 8) == 0) reads = uint64_t(std::max(1, std::atoi(a + 8)));
+        else if (std::strncmp(a, "--poll-us=", 10) == 0) pollUs = unsigned(std::max(0, std::atoi(a + 10)));
+        else if (std::strncmp(a, "--max-rtt-us=", 13) == 0) maxRttUs = std::atof(a + 13);
+        else { std::fprintf(stderr, "unknown option: %s\n", a); return 2; }
+    }
+
+    SettingsCell settings;
+    ControlPlane plane;
+    ControlPlane::Options o;
+    o.name = "bench-" + std::to_string(detail::currentPid());
+    o.pollMinUs = std::min(pollUs, o.pollMinUs);
+    o.pollMaxUs = pollUs;
+    auto apply = [&](const ControlCommand& c) {
+        settings.update([&](MotionSettings& s) { s.sensitivity = clampSensitivity(c.value); });
+        return true;
+    };
+    auto fill = [&](ControlStatus& s) {
+        s.settings = settings.load();
+        s.settingsVersion = settings.version();
+    };
+    std::string error;
+    if (!plane.start(o, apply, fill, &error)) { std::fprintf(stderr, "%s\n", error.c_str()); return 2; }
+
+    using clk = std::chrono::steady_clock;
+    auto nsSince = [](clk::time_point t0) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - t0).count();
+    };
+
+    // 1. Throughput: every client pushes flat out; a full mailbox means yield and retry.
+    std::atomic<uint64_t> fullRetries{0}, lastTicket{0};
+    std::vector<std::thread> pool;
+    const auto t0 = clk::now();
+    for (unsigned t = 0; t < clients; ++t) {
+        pool.emplace_back([&, t] {
+            ControlClient c;
+            if (!c.open(o.name)) return;
+            ControlCommand cmd;
+            cmd.op = ControlOp::SetSensitivity;
+            uint64_t full = 0, ticket = 0;
+            for (uint64_t i = 0; i < commands; ++i) {
+                cmd.value = 1.0 + double((i + t) % 16);
+                while (!(ticket = c.send(cmd))) { ++full; std::this_thread::yield(); }
+            }
+            fullRetries.fetch_add(full);
+            uint64_t prev = lastTicket.load();
+            while (prev < ticket && !lastTicket.compare_exchange_weak(prev, ticket)) {}
+        });
+    }
+    for (std::thread& th : pool) th.join();
+    ControlClient client;
+    if (!client.open(o.name, &error)) { std::fprintf(stderr, "%s\n", error.c_str()); return 2; }
+    client.wait(lastTicket.load(), 10000000000LL);
+    const double throughputS = double(nsSince(t0)) / 1e9;
+    const uint64_t total = uint64_t(clients) * commands;
+
+    // 2. Round trips: one command at a time, sent and waited for.
+    std::vector<int64_t> rttNs;
+    rttNs.reserve(size_t(rtt));
+    ControlCommand cmd;
+    cmd.op = ControlOp::SetSensitivity;
+    for (uint64_t i = 0; i < rtt; ++i) {
+        cmd.value = 1.0 + double(i % 16);
+        const auto s0 = clk::now();
+        const uint64_t ticket = client.send(cmd);
+        if (ticket && client.wait(ticket, 1000000000)) rttNs.push_back(nsSince(s0));
+    }
+
+    // 3. Status reads: what a dashboard polling the segment pays per snapshot.
+    uint64_t sink = 0;
+    const auto r0 = clk::now();
+    for (uint64_t i = 0; i < reads; ++i) sink += client.status().settingsVersion;
+    const double readNs = double(nsSince(r0)) / double(reads);
+
+    plane.stop();
+    std::fprintf(stderr, "clients=%u commands=%llu owner poll=%s\n", clients, (unsigned long long)total,
+                 pollUs ? (std::to_string(pollUs) + "us max").c_str() : "spin");
+    std::fprintf(stderr, "  throughput     %10.0f commands/s  (%llu applied, %llu mailbox-full retries)\n",
+                 double(total) / throughputS, (unsigned long long)plane.applied(),
+                 (unsigned long long)fullRetries.load());
+    const size_t completed = rttNs.size();
+    const double p50 = percentileUs(rttNs, 0.50), p99 = percentileUs(rttNs, 0.99), mx = percentileUs(rttNs, 1.0);
+    std::fprintf(stderr, "  round trip     p50/p99/max = %.1f/%.1f/%.1f us  (%zu of %llu)\n", p50, p99, mx, completed,
+                 (unsigned long long)rtt);
+    std::fprintf(stderr, "  status read    %10.1f ns  (%zu-byte snapshot, checksum %llu)\n", readNs,
+                 sizeof(ControlStatus), (unsigned long long)(sink & 0xff));
+    if (maxRttUs >= 0 && p99 > maxRttUs) {
+        std::fprintf(stderr, "FAIL: round-trip p99 %.1f us > %.1f us\n", p99, maxRttUs);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+// ControlTool.cpp — command-line client for a controller's shared-memory control plane
+//   g++ -std=c++17 -O2 -pthread tools/ControlTool.cpp -o ControlTool      (Linux, add -lrt on old glibc)
+//   cl /EHsc /std:c++17 tools\ControlTool.cpp                             (Windows)
+//   ControlTool [--name=<n>] status | watch [ms]
+//   ControlTool [--name=<n>] enable | disable | toggle | quit
+//   ControlTool [--name=<n>] sens <value> | step <delta> | preset <0-7> | curve on|off
+//   ControlTool [--name=<n>] serve [seconds]     stand-in owner without input hooks, for scripts and CI
+//
+// The controller must run with --control[=<name>] (default name: "default"). Commands wait up to
+// one second for the controller to apply them, then print the status it publishes. Exit status is
+// 1 when the controller is missing, the mailbox is full, the command is not applied in time or the
+// controller rejects it (preset index out of range, curve on V3).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "../core/ControlPlane.h"
+#include "../core/Profile.h"
+
+using namespace redmouse;
+
+static void printStatus(const ControlStatus& s, uint64_t pid) {
+    const TelemetrySnapshot& t = s.telemetry;
+    std::printf("pid %llu: %s, sensitivity %.7f, curve pattern %s, settings v%llu, %llu commands (%llu rejected)\n",
+                (unsigned long long)pid, s.settings.enabled ? "ENABLED" : "DISABLED", s.settings.sensitivity,
+                s.settings.curvePattern ? "on" : "off", (unsigned long long)s.settingsVersion,
+                (unsigned long long)s.commands, (unsigned long long)s.rejected);
+    std::printf("  ticks %llu, pixels %llu, missed %llu, jitter p50/p99=%.0f/%.0fus, inject p99=%.1fus\n",
+                (unsigned long long)t.ticks, (unsigned long long)t.pixels, (unsigned long long)t.missedTicks,
+                t.jitterP50 / 1e3, t.jitterP99 / 1e3, t.injectP99 / 1e3);
+}
+
+// What the real controllers do with a command, minus input: enough to exercise a client.
+static int serve(const std::string& name, double seconds) {
+    SettingsCell settings;
+    std::atomic<bool> quit{false};
+    ControlPlane plane;
+    ControlPlane::Options o;
+    o.name = name;
+    auto apply = [&](const ControlCommand& c) {
+        switch (c.op) {
+        case ControlOp::SetEnabled:      settings.update([&](MotionSettings& s) { s.enabled = c.arg != 0; }); return true;
+        case ControlOp::Toggle:          settings.update([](MotionSettings& s) { s.enabled = !s.enabled; }); return true;
+        case ControlOp::SetCurvePattern: settings.update([&](MotionSettings& s) { s.curvePattern = c.arg != 0; }); return true;
+        case ControlOp::SetSensitivity:
+            if (!std::isfinite(c.value)) return false;
+            settings.update([&](MotionSettings& s) { s.sensitivity = clampSensitivity(c.value); });
+            return true;
+        case ControlOp::StepSensitivity:
+            if (!std::isfinite(c.value)) return false;
+            settings.update([&](MotionSettings& s) { s.sensitivity = clampSensitivity(s.sensitivity + c.value); });
+            return true;
+        case ControlOp::Preset: {
+            const PresetTable t = PresetTable::builtIn();
+            if (c.arg < 0 || c.arg >= t.count) return false;
+            settings.update([&](MotionSettings& s) { s.sensitivity = clampSensitivity(t.entries[c.arg].sensitivity); });
+            return true;
+        }
+        case ControlOp::Quit: quit.store(true); return true;
+        default: return false;
+        }
+    };
+    auto fill = [&](ControlStatus& s) {
+        s.settings = settings.load();
+        s.settingsVersion = settings.version();
+    };
+    std::string error;
+    if (!plane.start(o, apply, fill, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "serving '%s'%s\n", name.c_str(), seconds > 0 ? "" : " until a quit command");
+    const int64_t end = seconds > 0 ? steadyNowNs() + int64_t(seconds * 1e9) : INT64_MAX;
+    while (!quit.load() && steadyNowNs() < end) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    plane.stop();
+    std::fprintf(stderr, "served %llu commands, %llu rejected\n", (unsigned long long)plane.applied(),
+                 (unsigned long long)plane.refused());
+    return 0;
+}
+
+static bool parseCommand(int argc, char** argv, int i, ControlCommand& c) {
+    const char* verb = argv[i];
+    const char* arg = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!std::strcmp(verb, "enable")) { c.op = ControlOp::SetEnabled; c.arg = 1; return true; }
+    if (!std::strcmp(verb, "disable")) { c.op = ControlOp::SetEnabled; c.arg = 0; return true; }
+    if (!std::strcmp(verb, "toggle")) { c.op = ControlOp::Toggle; return true; }
+    if (!std::strcmp(verb, "quit")) { c.op = ControlOp::Quit; return true; }
+    if (!arg) return false;
+    if (!std::strcmp(verb, "sens")) { c.op = ControlOp::SetSensitivity; c.value = std::atof(arg); return true; }
+    if (!std::strcmp(verb, "step")) { c.op = ControlOp::StepSensitivity; c.value = std::atof(arg); return true; }
+    if (!std::strcmp(verb, "preset")) { c.op = ControlOp::Preset; c.arg = std::atoi(arg); return true; }
+    if (!std::strcmp(verb, "curve")) { c.op = ControlOp::SetCurvePattern; c.arg = !std::strcmp(arg, "on"); return true; }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    std::string name = "default";
+    int i = 1;
+    if (i < argc && !std::strncmp(argv[i], "--name=", 7)) name = argv[i++] + 7;
+    if (i >= argc) {
+        std::fprintf(stderr, "usage: ControlTool [--name=<n>] status | watch [ms] | enable | disable | toggle | quit |\n"
+                             "       sens <value> | step <delta> | preset <0-7> | curve on|off | serve [seconds]\n");
+        return 2;
+    }
+    const char* verb = argv[i];
+    if (!std::strcmp(verb, "serve")) return serve(name, i + 1 < argc ? std::atof(argv[i + 1]) : 0.0);
+
+    ControlClient client;
+    std::string error;
+    if (!client.open(name, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (!client.ownerAlive()) std::fprintf(stderr, "warning: controller '%s' is not publishing\n", name.c_str());
+
+    if (!std::strcmp(verb, "status")) {
+        printStatus(client.status(), client.ownerPid());
+        return 0;
+    }
+    if (!std::strcmp(verb, "watch")) {
+        const int ms = i + 1 < argc ? std::max(10, std::atoi(argv[i + 1])) : 500;
+        while (client.ownerAlive(5000000000LL)) {
+            printStatus(client.status(), client.ownerPid());
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        }
+        std::fprintf(stderr, "controller stopped\n");
+        return 0;
+    }
+
+    ControlCommand c;
+    if (!parseCommand(argc, argv, i, c)) {
+        std::fprintf(stderr, "unknown or incomplete command: %s\n", verb);
+        return 2;
+    }
+    const uint64_t before = client.status().rejected;
+    const uint64_t ticket = client.send(c);
+    if (!ticket) {
+        std::fprintf(stderr, "mailbox full: controller '%s' is not draining it\n", name.c_str());
+        return 1;
+    }
+    if (!client.wait(ticket, 1000000000)) {
+        std::fprintf(stderr, "%s: not applied within 1 s\n", controlOpName(c.op));
+        return 1;
+    }
+    if (c.op == ControlOp::Quit) return 0;
+    // The owner republishes right after a batch; wait for that status, not the previous one.
+    ControlStatus s = client.status();
+    for (int spins = 0; s.commands + s.rejected < ticket && spins < 1000; ++spins) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        s = client.status();
+    }
+    const bool rejected = s.rejected > before;
+    if (rejected) std::fprintf(stderr, "%s: rejected (or another client's command was)\n", controlOpName(c.op));
+    printStatus(s, client.ownerPid());
+    return rejected ? 1 : 0;
+}
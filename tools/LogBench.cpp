@@ -0,0 +1,111 @@
+// LogBench.cpp — producer cost of core/Log.h: ns per call on the logging thread, drops, drain cost
+//   g++ -std=c++17 -O2 -pthread tools/LogBench.cpp -o LogBench      (Linux)
+//   cl /EHsc /std:c++17 tools\LogBench.cpp                          (Windows)
+//   LogBench [--threads=<n>] [--calls=<n>] [--interval-us=<us>] [--ring=<records>]
+//            [--out=discard|console|<file>] [--repeat=<n>] [--max-ns=<ns>]
+// Every thread logs a telemetry-style line (integers, doubles, a copied string). Flat out (the
+// default) a thread logs in bursts of one ring (--ring, default 4096 records), flushes between
+// bursts outside the timer, and ns/call is the time spent inside the bursts: the cost of a call into
+// a warm ring, which is what a controller's small rings see. Each flush clears the drain thread's
+// wake event, so the first call of every burst pays the wake-up signal, as it would after a real
+// drain; producer_ns includes it and wake_ns shows it alone. With --interval-us each call is timed
+// on its own, and a small --ring shows drops instead of waits.
+// --repeat runs the whole thing n times with a fresh logger and reports the fastest pass.
+// Exit status is 1 when the logger's own producer counter passes --max-ns.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../core/Log.h"
+
+int main(int argc, char** argv) {
+    unsigned threads = 2, intervalUs = 0;
+    uint64_t calls = 200000, ring = 0;
+    int repeat = 1;
+    double maxNs = -1;
+    const char* out = "discard";
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strncmp(a, "--threads=", 10) == 0) threads = unsigned(std::max(1, std::atoi(a + 10)));
+        else if (std::strncmp(a, "--calls=", 8) == 0) calls = uint64_t(std::max(1, std::atoi(a + 8)));
+        else if (std::strncmp(a, "--interval-us=", 14) == 0) intervalUs = unsigned(std::max(0, std::atoi(a + 14)));
+        else if (std::strncmp(a, "--ring=", 7) == 0) ring = uint64_t(std::max(1, std::atoi(a + 7)));
+        else if (std::strncmp(a, "--out=", 6) == 0) out = a + 6;
+        else if (std::strncmp(a, "--repeat=", 9) == 0) repeat = std::max(1, std::atoi(a + 9));
+        else if (std::strncmp(a, "--max-ns=", 9) == 0) maxNs = std::atof(a + 9);
+        else { std::fprintf(stderr, "unknown option: %s\n", a); return 2; }
+    }
+
+    redmouse::Logger::Options lo;
+    lo.discard = std::strcmp(out, "discard") == 0;
+    if (!lo.discard && std::strcmp(out, "console") != 0) lo.path = out;
+    lo.ringRecords = size_t(ring ? ring : intervalUs ? 512 : std::min<uint64_t>(calls, 4096));
+
+    using clk = std::chrono::steady_clock;
+    redmouse::LogStats s;
+    double worst = 0;
+    for (int r = 0; r < repeat; ++r) {
+        redmouse::Logger log;
+        if (!log.start(lo)) { std::fprintf(stderr, "cannot open %s\n", out); return 2; }
+        std::vector<double> nsPerCall(threads);
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                const char* sink = t % 2 ? "sendinput" : "uinput";
+                auto call = [&](uint64_t i) {
+                    log.info("[tick] thread=%u n=%llu jitter p50/p99=%.0f/%.0fus sink=%s\n", t,
+                             (unsigned long long)i, 12.5 + double(i % 7), 80.25, sink);
+                };
+                int64_t busyNs = 0;
+                if (intervalUs) {
+                    auto next = clk::now();
+                    for (uint64_t i = 0; i < calls; ++i) {
+                        const auto t0 = clk::now();
+                        call(i);
+                        busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - t0).count();
+                        next += std::chrono::microseconds(intervalUs);
+                        std::this_thread::sleep_until(next);
+                    }
+                } else {
+                    call(0); // registers this thread's ring outside the timed loop
+                    log.flush();
+                    for (uint64_t i = 1; i < calls;) {
+                        const uint64_t end = std::min<uint64_t>(calls, i + lo.ringRecords);
+                        const auto t0 = clk::now();
+                        for (; i < end; ++i) call(i);
+                        busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - t0).count();
+                        log.flush();
+                    }
+                }
+                nsPerCall[t] = double(busyNs) / double(intervalUs ? calls : calls - 1);
+            });
+        }
+        for (std::thread& th : pool) th.join();
+        log.stop();
+
+        // Only the timing varies between passes; keep the fastest.
+        const redmouse::LogStats ps = log.stats();
+        double pw = 0;
+        for (double v : nsPerCall) pw = std::max(pw, v);
+        if (r == 0 || ps.producerNs < s.producerNs) { s = ps; worst = pw; }
+    }
+    std::fprintf(stderr, "threads=%u calls=%llu out=%s\n", threads, (unsigned long long)calls, out);
+    std::fprintf(stderr, "  ns/call        %8.1f  (worst thread)\n", worst);
+    std::fprintf(stderr, "  producer_ns    %8.1f  (logger's own counters, wake-ups included)\n", s.producerNs);
+    std::fprintf(stderr, "  wake_ns        %8.1f  (%llu calls signalled the drain thread)\n", s.wakeNs,
+                 (unsigned long long)s.wakes);
+    std::fprintf(stderr, "  records        %8llu  dropped %llu\n", (unsigned long long)s.records,
+                 (unsigned long long)s.dropped);
+    std::fprintf(stderr, "  drain ns/rec   %8.1f  bytes %llu, rotations %llu\n", s.drainNs,
+                 (unsigned long long)s.bytes, (unsigned long long)s.rotations);
+    if (maxNs >= 0 && s.producerNs > maxNs) {
+        std::fprintf(stderr, "FAIL: producer cost %.1f ns > %.1f ns\n", s.producerNs, maxNs);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,402 @@
+// MotionBench.cpp — headless, deterministic benchmark of the motion integrators under a virtual clock
+//   g++ -std=c++17 -O2 tools/MotionBench.cpp -o MotionBench
+//   MotionBench [--rate-fixed=Hz] [--rate-v3=Hz] [--repeat=N] [--max-err=px] [--max-ns=ns]
+//               [--start=zero|immediate|half|carry] [trace.txt ...]
+//   MotionBench --start-latency [--presses=N]
+//
+// Trace files (and the built-in scenarios) are line based, times in milliseconds:
+//   press   <t>              left button down
+//   release <t>              left button up
+//   sens    <t> <value>      sensitivity change
+//   stall   <t> <ms>         the tick at/after t overruns by <ms> (curve path, preemption...)
+//   jitter  <t> <us>         from t on, each wake-up lands uniformly 0..<us> late
+// Integrators: "fixed" (MouseRed), "clamped" (V3) and "q32" (fixed-point, on V3's tick rate).
+// "event" is q32 with --emit=event: one wake-up per pixel (plus one per trace event, standing in for
+// the settings kick), so its ticks column counts wake-ups.
+// lag_us is the worst age of the newest pixel at the moment it was emitted.
+// The hash column is FNV-1a over the emitted (time, dy) stream: equal hashes mean bit-identical output.
+// Exit status is 1 when a --max-* threshold is exceeded, so CI can gate on it.
+// --start-latency plays a seeded random press/hold trace through every integrator with every start
+// policy and reports press -> first move (timestamps from the mock sink, on the virtual clock) and
+// the pixels each policy adds per press over the ideal distance.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../core/InputSink.h"
+#include "../core/MotionIntegrator.h"
+#include "../core/Presets.h"
+#include "../core/TickScheduler.h"
+
+using namespace redmouse;
+
+namespace {
+
+struct TraceEvent {
+    enum Kind { Press, Release, Sens, Stall, Jitter } kind;
+    int64_t tNs;
+    double  value;
+};
+
+struct Trace {
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+bool parseTrace(const std::string& name, const std::string& text, Trace& out) {
+    out.name = name;
+    out.events.clear();
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        std::istringstream ls(line);
+        std::string verb;
+        if (!(ls >> verb)) continue;
+        double tMs = 0, v = 0;
+        if (!(ls >> tMs)) { std::fprintf(stderr, "%s:%d: missing time\n", name.c_str(), lineNo); return false; }
+        TraceEvent e{ TraceEvent::Press, int64_t(tMs * 1e6), 0.0 };
+        if (verb == "press") e.kind = TraceEvent::Press;
+        else if (verb == "release") e.kind = TraceEvent::Release;
+        else if (verb == "sens"   && (ls >> v)) { e.kind = TraceEvent::Sens;   e.value = v; }
+        else if (verb == "stall"  && (ls >> v)) { e.kind = TraceEvent::Stall;  e.value = v * 1e6; }
+        else if (verb == "jitter" && (ls >> v)) { e.kind = TraceEvent::Jitter; e.value = v * 1e3; }
+        else { std::fprintf(stderr, "%s:%d: bad line\n", name.c_str(), lineNo); return false; }
+        out.events.push_back(e);
+    }
+    std::stable_sort(out.events.begin(), out.events.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) { return a.tNs < b.tNs; });
+    return true;
+}
+
+std::vector<Trace> builtinTraces() {
+    std::string taps;
+    for (int i = 0; i < 50; ++i) {
+        taps += "press "   + std::to_string(i * 300) + "\n";
+        taps += "release " + std::to_string(i * 300 + 200) + "\n";
+    }
+    std::string steps = "press 0\n";
+    for (int i = 0; i < kPresetCount; ++i) steps += "sens " + std::to_string(i * 2000) + " " + std::to_string(kPresets[i]) + "\n";
+    steps += "release 16000\n";
+    std::string hiccups = "press 0\n";
+    for (int i = 1; i < 20; ++i) hiccups += "stall " + std::to_string(i * 500) + " " + std::to_string(10 + (i % 4) * 10) + "\n";
+    hiccups += "release 10000\n";
+
+    const std::pair<const char*, std::string> src[] = {
+        { "taps",       taps },
+        { "hold60s",    "press 0\nrelease 60000\n" },
+        { "hold1h",     "jitter 0 300\npress 0\nrelease 3600000\n" },
+        { "sens-steps", steps },
+        { "hiccups",    hiccups },
+        { "jitter",     "jitter 0 1500\npress 0\nrelease 10000\n" },
+    };
+    std::vector<Trace> out;
+    for (const auto& s : src) {
+        Trace t;
+        parseTrace(s.first, s.second, t);
+        out.push_back(t);
+    }
+    return out;
+}
+
+// VirtualClock whose wake-ups can land late, from a fixed-seed LCG: identical runs every time.
+class JitterClock {
+public:
+    int64_t nowNs() const { return t; }
+    void sleepUntil(int64_t deadlineNs, int64_t) {
+        if (deadlineNs > t) t = deadlineNs;
+        if (maxLateNs > 0) {
+            rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+            t += int64_t((rng >> 33) % uint64_t(maxLateNs + 1));
+        }
+    }
+    bool sleepUntil(int64_t deadlineNs, int64_t spinNs, const WakeEvent*) {
+        sleepUntil(deadlineNs, spinNs);
+        return true;
+    }
+    void advance(int64_t ns) { t += ns; }
+    void set(int64_t ns) { t = ns; }
+    void setJitter(int64_t ns) { maxLateNs = ns; }
+
+private:
+    int64_t  t = 0;
+    int64_t  maxLateNs = 0;
+    uint64_t rng = 0x5eed;
+};
+
+struct RunStats {
+    uint64_t ticks = 0;
+    int64_t  emitted = 0;
+    double   ideal = 0;
+    double   maxAbsErr = 0;
+    double   intervalMeanUs = 0, intervalStdUs = 0;
+    double   nsPerTick = 0;
+    double   maxLagUs = 0;
+    uint64_t dtClamps = 0, accClamps = 0, missed = 0;
+    uint32_t hash = 2166136261u;
+    uint64_t presses = 0;
+    std::vector<int64_t> firstMoveNs; // per press that moved at all
+};
+
+void hashMix(uint32_t& h, int64_t v) {
+    for (int i = 0; i < 8; ++i) h = (h ^ uint8_t(v >> (8 * i))) * 16777619u;
+}
+
+constexpr int64_t kMaxEventSleepNs = 250000000; // same cap as the apps
+
+template <class Integrator, bool EventScheduled = false>
+RunStats run(const Trace& tr, Integrator integ, TickScheduler<JitterClock>::Config cfg,
+             StartPolicy policy = StartPolicy::Zero) {
+    TickScheduler<JitterClock> sched(cfg);
+    JitterClock& clk = sched.clock();
+    RecordingSink sink(1u << 18);
+    sink.setTimeSource([](const void* c) { return static_cast<const JitterClock*>(c)->nowNs(); }, &clk);
+
+    RunStats st;
+    bool down = false;
+    double sens = kDefaultSensitivity;
+    double idealT = 0;
+    int64_t lastEmitNs = -1;
+    int64_t pressNs = -1; // until the first move after it
+    double lagBase = 0; // ideal - emitted at the last press: pixels lost to earlier releases aren't lag
+    double sum = 0, sumSq = 0;
+    uint64_t intervals = 0;
+    size_t next = 0;
+    const std::vector<TraceEvent>& ev = tr.events;
+
+    auto advanceIdeal = [&](int64_t t) {
+        if (down) st.ideal += sens * kPixelsPerSecond * (double(t) - idealT) * 1e-9;
+        idealT = double(t);
+    };
+    // Applies every event up to t; returns the stall (ns) requested in that window.
+    auto apply = [&](int64_t t) {
+        int64_t stall = 0;
+        for (; next < ev.size() && ev[next].tNs <= t; ++next) {
+            const TraceEvent& e = ev[next];
+            advanceIdeal(e.tNs);
+            switch (e.kind) {
+            case TraceEvent::Press:
+                if (!down) {
+                    down = true;
+                    clk.set(std::max(clk.nowNs(), e.tNs));
+                    sched.reset();
+                    integ.start(clk.nowNs(), policy);
+                    lastEmitNs = -1;
+                    pressNs = clk.nowNs();
+                    ++st.presses;
+                    lagBase = st.ideal - double(st.emitted);
+                }
+                break;
+            case TraceEvent::Release: down = false; pressNs = -1; break;
+            case TraceEvent::Sens:    sens = e.value; break;
+            case TraceEvent::Stall:   stall += int64_t(e.value); break;
+            case TraceEvent::Jitter:  clk.setJitter(int64_t(e.value)); break;
+            }
+        }
+        return stall;
+    };
+
+    const auto wall0 = std::chrono::steady_clock::now();
+    while (next < ev.size() || down) {
+        if (!down) {
+            // Parked: jump straight to the next event, like the gate wait in the real loop.
+            clk.set(std::max(clk.nowNs(), ev[next].tNs));
+            apply(clk.nowNs());
+            continue;
+        }
+        // Event mode steps with the sensitivity its sleep was timed for, as the apps do.
+        const double stepSens = sens;
+        Tick tick;
+        if constexpr (EventScheduled) {
+            int64_t deadline = std::min(integ.nextPixelNs(sens), clk.nowNs() + kMaxEventSleepNs);
+            if (next < ev.size()) deadline = std::min(deadline, ev[next].tNs);
+            tick = sched.waitUntil(deadline, nullptr);
+        } else {
+            tick = sched.wait();
+        }
+        const int64_t stall = apply(tick.actualNs);
+        if (!EventScheduled && !down) continue;
+        advanceIdeal(tick.actualNs);
+
+        const StepResult r = integ.step(EventScheduled ? stepSens : sens, tick);
+        ++st.ticks;
+        if (r.flags & TickDtClamped)  ++st.dtClamps;
+        if (r.flags & TickAccClamped) ++st.accClamps;
+        if (r.flags & TickMissed)     ++st.missed;
+        if (r.dy > 0) {
+            if (sink.moveRelative(0, r.dy) && pressNs >= 0) {
+                st.firstMoveNs.push_back(sink[sink.size() - 1].tNs - pressNs);
+                pressNs = -1;
+            }
+            st.emitted += r.dy;
+            hashMix(st.hash, tick.actualNs);
+            hashMix(st.hash, r.dy);
+            if (lastEmitNs >= 0) {
+                const double us = double(tick.actualNs - lastEmitNs) * 1e-3;
+                sum += us; sumSq += us * us; ++intervals;
+            }
+            lastEmitNs = tick.actualNs;
+            const double lagPx = st.ideal - double(st.emitted) - lagBase;
+            if (stepSens > 0 && lagPx > 0)
+                st.maxLagUs = std::max(st.maxLagUs, lagPx / (stepSens * kPixelsPerSecond) * 1e6);
+        }
+        st.maxAbsErr = std::max(st.maxAbsErr, std::fabs(st.ideal - double(st.emitted)));
+        if (stall) clk.advance(stall);
+    }
+    const double wallNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wall0).count());
+
+    st.nsPerTick = st.ticks ? wallNs / double(st.ticks) : 0.0;
+    if (intervals) {
+        st.intervalMeanUs = sum / double(intervals);
+        st.intervalStdUs = std::sqrt(std::max(0.0, sumSq / double(intervals) - st.intervalMeanUs * st.intervalMeanUs));
+    }
+    return st;
+}
+
+void printRow(const char* trace, const char* integ, const RunStats& s) {
+    std::printf("%-11s %-8s %9llu %9lld %10.1f %8.2f %8.2f %10.0f %9.0f %8.0f %7.1f %6llu %6llu %6llu  %08x\n",
+        trace, integ, (unsigned long long)s.ticks, (long long)s.emitted, s.ideal,
+        s.ideal - double(s.emitted), s.maxAbsErr, s.intervalMeanUs, s.intervalStdUs, s.maxLagUs, s.nsPerTick,
+        (unsigned long long)s.dtClamps, (unsigned long long)s.accClamps, (unsigned long long)s.missed,
+        unsigned(s.hash));
+}
+
+// Short presses with rests between them, across the presets: where the start policy matters.
+Trace startLatencyTrace(int presses) {
+    uint64_t rng = 0x5eed;
+    auto next = [&rng](uint64_t n) {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return (rng >> 33) % n;
+    };
+    std::string text = "jitter 0 300\n";
+    int64_t tMs = 0;
+    for (int i = 0; i < presses; ++i) {
+        tMs += 150 + int64_t(next(500));
+        text += "sens " + std::to_string(tMs) + " " + std::to_string(kPresets[next(kPresetCount)]) + "\n";
+        text += "press " + std::to_string(tMs) + "\n";
+        tMs += 40 + int64_t(next(360));
+        text += "release " + std::to_string(tMs) + "\n";
+    }
+    Trace t;
+    parseTrace("presses", text, t);
+    return t;
+}
+
+double percentileMs(std::vector<int64_t> v, double q) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return double(v[std::min(v.size() - 1, size_t(q * double(v.size())))]) * 1e-6;
+}
+
+void printLatencyRow(const char* integ, StartPolicy p, const RunStats& s) {
+    std::printf("%-8s %-10s %8llu %8llu %8.2f %8.2f %8.2f %8.2f %11.3f\n", integ, startPolicyName(p),
+        (unsigned long long)s.presses, (unsigned long long)(s.presses - s.firstMoveNs.size()),
+        percentileMs(s.firstMoveNs, 0.50), percentileMs(s.firstMoveNs, 0.90), percentileMs(s.firstMoveNs, 0.99),
+        percentileMs(s.firstMoveNs, 1.0), s.presses ? (double(s.emitted) - s.ideal) / double(s.presses) : 0.0);
+}
+
+int startLatency(int presses, const TickScheduler<JitterClock>::Config& fixedCfg,
+                 const TickScheduler<JitterClock>::Config& v3Cfg) {
+    const Trace tr = startLatencyTrace(presses);
+    std::printf("%-8s %-10s %8s %8s %8s %8s %8s %8s %11s\n", "integ", "start", "presses", "no_move",
+        "p50_ms", "p90_ms", "p99_ms", "max_ms", "extra_px/pr");
+    for (int i = 0; i <= int(StartPolicy::Carry); ++i) {
+        const StartPolicy p = StartPolicy(i);
+        printLatencyRow("fixed", p, run(tr, FixedStepIntegrator(), fixedCfg, p));
+        printLatencyRow("clamped", p, run(tr, ClampedDtIntegrator(), v3Cfg, p));
+        printLatencyRow("q32", p, run(tr, FixedPointIntegrator(), v3Cfg, p));
+        printLatencyRow("event", p, run<FixedPointIntegrator, true>(tr, FixedPointIntegrator(), v3Cfg, p));
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t rateFixed = 100, rateV3 = 1000;
+    int repeat = 1;
+    double maxErr = -1, maxNs = -1;
+    StartPolicy policy = StartPolicy::Zero;
+    bool latency = false;
+    int presses = 500;
+    std::vector<Trace> traces;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strncmp(a, "--rate-fixed=", 13) == 0) rateFixed = uint32_t(std::atoi(a + 13));
+        else if (std::strncmp(a, "--rate-v3=", 10) == 0) rateV3 = uint32_t(std::atoi(a + 10));
+        else if (std::strncmp(a, "--repeat=", 9) == 0) repeat = std::max(1, std::atoi(a + 9));
+        else if (std::strncmp(a, "--max-err=", 10) == 0) maxErr = std::atof(a + 10);
+        else if (std::strncmp(a, "--max-ns=", 9) == 0) maxNs = std::atof(a + 9);
+        else if (std::strncmp(a, "--start=", 8) == 0) {
+            if (!parseStartPolicy(a + 8, policy)) { std::fprintf(stderr, "unknown start policy %s\n", a + 8); return 2; }
+        }
+        else if (std::strcmp(a, "--start-latency") == 0) latency = true;
+        else if (std::strncmp(a, "--presses=", 10) == 0) presses = std::max(1, std::atoi(a + 10));
+        else {
+            std::FILE* f = std::fopen(a, "rb");
+            if (!f) { std::fprintf(stderr, "cannot open %s\n", a); return 2; }
+            std::string text;
+            char buf[4096];
+            size_t n;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+            std::fclose(f);
+            Trace t;
+            if (!parseTrace(a, text, t)) return 2;
+            traces.push_back(t);
+        }
+    }
+    if (traces.empty()) traces = builtinTraces();
+
+    // Same scheduler settings as the shipping loops.
+    TickScheduler<JitterClock>::Config fixedCfg;
+    fixedCfg.rateHz = rateFixed;
+    fixedCfg.overrun = Overrun::CatchUp;
+    fixedCfg.maxCatchUp = 10;
+    TickScheduler<JitterClock>::Config v3Cfg;
+    v3Cfg.rateHz = rateV3;
+    if (latency) return startLatency(presses, fixedCfg, v3Cfg);
+
+    std::printf("%-11s %-8s %9s %9s %10s %8s %8s %10s %9s %8s %7s %6s %6s %6s  %-8s\n",
+        "trace", "integ", "ticks", "emitted", "ideal", "err_px", "maxerr", "ivl_us", "ivl_sd", "lag_us", "ns/tk",
+        "dtclmp", "acclmp", "missed", "hash");
+
+    bool fail = false;
+    for (const Trace& tr : traces) {
+        RunStats fx, v3, q32, evt;
+        for (int r = 0; r < repeat; ++r) {
+            RunStats a = run(tr, FixedStepIntegrator(), fixedCfg, policy);
+            RunStats b = run(tr, ClampedDtIntegrator(), v3Cfg, policy);
+            RunStats c = run(tr, FixedPointIntegrator(), v3Cfg, policy);
+            RunStats d = run<FixedPointIntegrator, true>(tr, FixedPointIntegrator(), v3Cfg, policy);
+            // Output is deterministic; only the timing varies, so keep the fastest pass.
+            if (r == 0 || a.nsPerTick < fx.nsPerTick) fx = a;
+            if (r == 0 || b.nsPerTick < v3.nsPerTick) v3 = b;
+            if (r > 0 && c.hash != q32.hash) { std::printf("FAIL: q32 output differs between passes\n"); fail = true; }
+            if (r == 0 || c.nsPerTick < q32.nsPerTick) q32 = c;
+            if (r > 0 && d.hash != evt.hash) { std::printf("FAIL: event output differs between passes\n"); fail = true; }
+            if (r == 0 || d.nsPerTick < evt.nsPerTick) evt = d;
+        }
+        printRow(tr.name.c_str(), "fixed", fx);
+        printRow(tr.name.c_str(), "clamped", v3);
+        printRow(tr.name.c_str(), "q32", q32);
+        printRow(tr.name.c_str(), "event", evt);
+        for (const RunStats* s : { &fx, &v3, &q32, &evt }) {
+            if (maxErr >= 0 && s->maxAbsErr > maxErr) fail = true;
+            if (maxNs >= 0 && s->nsPerTick > maxNs) fail = true;
+        }
+    }
+    if (fail) std::printf("FAIL: threshold exceeded\n");
+    return fail ? 1 : 0;
+}
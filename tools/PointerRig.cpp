@@ -0,0 +1,125 @@
+// PointerRig.cpp — drives N independent virtual pointers from one process (core/ControllerPool.h)
+//   g++ -std=c++17 -O2 -pthread tools/PointerRig.cpp -o PointerRig      (Linux)
+//   cl /EHsc /std:c++17 tools\PointerRig.cpp user32.lib                (Windows)
+//   PointerRig [--controllers=<n>] [--workers=<n>] [--seconds=<s>] [--sink=null|uinput|sendinput]
+//              [--curve-every=<k>] [--spin-us=<us>]
+// Controller i gets its own sink (uinput: one virtual device each) and sensitivity, holds for 400 ms,
+// rests for 100 ms, staggered by 7 ms; every k-th one uses Curve Pattern. Prints throughput,
+// scheduler wake-ups and how late the workers picked streams up.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "../core/ControllerPool.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Counts and discards: lets hundreds of streams run for minutes without a log per stream.
+class NullSink final : public redmouse::InputSink {
+public:
+    const char* name() const override { return "null"; }
+    bool moveRelative(int dx, int dy) override {
+        if (dx == 0 && dy == 0) return true;
+        account(0, 1, dx, dy);
+        return true;
+    }
+};
+
+std::unique_ptr<redmouse::InputSink> makeRigSink(const char* kind, unsigned i) {
+    if (std::strcmp(kind, "null") == 0) return std::make_unique<NullSink>();
+#ifdef __linux__
+    if (std::strcmp(kind, "uinput") == 0) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "RedMouse rig pointer %u", i);
+        auto s = std::make_unique<redmouse::UinputSink>(name);
+        if (s->ok()) return s;
+        return nullptr;
+    }
+#endif
+    return redmouse::makeSink(kind);
+}
+
+double cpuSeconds() {
+#ifdef __linux__
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return double(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + double(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+#else
+    return 0.0;
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned controllers = 32, curveEvery = 4;
+    double seconds = 5.0;
+    const char* kind = "null";
+    redmouse::ControllerPool::Options po;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strncmp(a, "--controllers=", 14) == 0) controllers = unsigned(std::max(1, std::atoi(a + 14)));
+        else if (std::strncmp(a, "--workers=", 10) == 0) po.workers = unsigned(std::max(0, std::atoi(a + 10)));
+        else if (std::strncmp(a, "--seconds=", 10) == 0) seconds = std::atof(a + 10);
+        else if (std::strncmp(a, "--sink=", 7) == 0) kind = a + 7;
+        else if (std::strncmp(a, "--curve-every=", 14) == 0) curveEvery = unsigned(std::max(0, std::atoi(a + 14)));
+        else if (std::strncmp(a, "--spin-us=", 10) == 0) po.spinNs = int64_t(std::atoi(a + 10)) * 1000;
+        else { std::fprintf(stderr, "unknown option: %s\n", a); return 1; }
+    }
+
+    redmouse::ControllerPool pool(po);
+    for (unsigned i = 0; i < controllers; ++i) {
+        auto sink = makeRigSink(kind, i);
+        if (!sink) {
+            std::fprintf(stderr, "sink '%s' unavailable (uinput needs write access to /dev/uinput)\n", kind);
+            return 1;
+        }
+        redmouse::MotionSettings s;
+        s.sensitivity = 0.5 + 0.25 * double(i % 16);
+        s.curvePattern = curveEvery && i % curveEvery == 0;
+        pool.add(std::move(sink), s);
+    }
+    pool.start();
+
+    // The driver plays the button: 400 ms held, 100 ms released, each controller offset by 7 ms.
+    using clk = std::chrono::steady_clock;
+    const auto t0 = clk::now();
+    const double cpu0 = cpuSeconds();
+    std::vector<char> held(controllers, 0);
+    for (;;) {
+        const auto now = clk::now();
+        const int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - t0).count();
+        if (ms >= int64_t(seconds * 1000)) break;
+        for (unsigned i = 0; i < controllers; ++i) {
+            const bool want = (ms + 7 * int64_t(i)) % 500 < 400;
+            if (want != bool(held[i])) {
+                held[i] = want;
+                want ? pool.press(i) : pool.release(i);
+            }
+        }
+        std::this_thread::sleep_until(now + std::chrono::milliseconds(1));
+    }
+    for (unsigned i = 0; i < controllers; ++i) pool.release(i);
+    pool.stop();
+    const double wall = std::chrono::duration<double>(clk::now() - t0).count();
+    const double cpu = cpuSeconds() - cpu0;
+
+    const redmouse::PoolStats s = pool.stats();
+    std::printf("controllers=%llu workers=%llu sink=%s seconds=%.1f\n", (unsigned long long)s.streams,
+                (unsigned long long)s.workers, kind, wall);
+    std::printf("  services/s     %12.0f\n", double(s.services) / wall);
+    std::printf("  moves/s        %12.0f\n", double(s.moves) / wall);
+    std::printf("  pixels         %12llu\n", (unsigned long long)s.pixels);
+    std::printf("  sched wakeups  %12llu\n", (unsigned long long)s.schedulerWakeups);
+    std::printf("  late_us        p50=%.1f p99=%.1f max=%.1f\n", s.lateP50Ns / 1e3, s.lateP99Ns / 1e3, s.lateMaxNs / 1e3);
+    if (cpu > 0.0) std::printf("  cpu            %11.1f%%  (%.2f us per service)\n", 100.0 * cpu / wall,
+                               s.services ? cpu * 1e6 / double(s.services) : 0.0);
+    return 0;
+}
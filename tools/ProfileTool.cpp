@@ -0,0 +1,186 @@
+// ProfileTool.cpp — build, dump and seed RedMouse binary profiles (.rmp)
+//   g++ -std=c++17 -O2 tools/ProfileTool.cpp -o ProfileTool      (Linux)
+//   cl /EHsc /std:c++17 tools\ProfileTool.cpp                    (Windows)
+//   ProfileTool defaults out.rmp        built-in F2-F9 presets and the legacy curve
+//   ProfileTool build in.txt out.rmp    text description -> binary
+//   ProfileTool dump file.rmp
+//
+// Text format ('#' starts a comment; curve lines attach to the most recent curve):
+//   curve  <name> <stroke_ms> [samples]
+//   cubic  x0 y0 x1 y1 x2 y2 x3 y3 [weight]
+//   quad   x0 y0 cx cy x1 y1 [weight]
+//   preset <name> <sensitivity> [curve-name]
+//   headless                          V3 starts without its window (tray icon / hotkey opens it)
+//
+// Output is written to <out>.tmp and renamed over <out>, so a running controller never maps a
+// half-written file.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../core/Profile.h"
+
+using namespace redmouse;
+
+static void setName(char (&dst)[kProfileNameBytes], const char* src) {
+    const size_t n = std::strlen(src);
+    std::memset(dst, 0, sizeof(dst));
+    std::memcpy(dst, src, n < sizeof(dst) - 1 ? n : sizeof(dst) - 1);
+}
+
+static SegmentRecord toRecord(const BezierSegment& b) {
+    SegmentRecord r{};
+    std::memcpy(r.x, b.x, sizeof(r.x));
+    std::memcpy(r.y, b.y, sizeof(r.y));
+    r.weight = b.weight;
+    return r;
+}
+
+struct Image {
+    std::vector<PresetRecord>  presets;
+    std::vector<CurveRecord>   curves;
+    std::vector<SegmentRecord> segments;
+    std::vector<std::string>   pendingCurveNames; // preset -> curve name, resolved after parsing
+    uint32_t                   flags = 0;
+};
+
+static bool writeImage(const Image& img, const char* out) {
+    const std::vector<uint8_t> bytes = Profile::build(img.presets, img.curves, img.segments, img.flags);
+    const std::string tmp = std::string(out) + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) { std::fprintf(stderr, "cannot write %s\n", tmp.c_str()); return false; }
+    const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    if (std::fclose(f) != 0 || !ok) { std::fprintf(stderr, "write failed: %s\n", tmp.c_str()); return false; }
+#ifdef _WIN32
+    if (!MoveFileExA(tmp.c_str(), out, MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (std::rename(tmp.c_str(), out) != 0) {
+#endif
+        std::fprintf(stderr, "cannot replace %s\n", out);
+        return false;
+    }
+    std::printf("%s: %zu presets, %zu curves, %zu segments, %zu bytes\n", out,
+                img.presets.size(), img.curves.size(), img.segments.size(), bytes.size());
+    return true;
+}
+
+static Image defaults() {
+    Image img;
+    CurveRecord c{};
+    setName(c.name, "legacy-bob");
+    c.firstSegment = 0;
+    c.segmentCount = 1;
+    c.strokeUs = 10000;
+    img.curves.push_back(c);
+    img.segments.push_back(toRecord(BezierSegment::quadratic(0, 0, 0, -5, 0, 0)));
+    const PresetTable t = PresetTable::builtIn();
+    for (int i = 0; i < t.count; ++i) {
+        PresetRecord p{};
+        setName(p.name, t.entries[i].name);
+        p.sensitivity = t.entries[i].sensitivity;
+        p.curve = -1;
+        img.presets.push_back(p);
+    }
+    return img;
+}
+
+static bool parse(const char* path, Image& img) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) { std::fprintf(stderr, "cannot open %s\n", path); return false; }
+    char line[512];
+    int lineNo = 0;
+    bool ok = true;
+    while (std::fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        if (char* hash = std::strchr(line, '#')) *hash = 0;
+        char kw[16] = "", name[64] = "", extra[64] = "";
+        float v[9] = {};
+        if (std::sscanf(line, "%15s", kw) != 1) continue;
+        const char* rest = line + std::strspn(line, " \t") + std::strlen(kw);
+
+        if (!std::strcmp(kw, "curve")) {
+            unsigned ms = 0, samples = 0;
+            if (std::sscanf(rest, "%63s %u %u", name, &ms, &samples) < 2 || ms == 0) { ok = false; break; }
+            CurveRecord c{};
+            setName(c.name, name);
+            c.firstSegment = uint32_t(img.segments.size());
+            c.strokeUs = ms * 1000;
+            c.samples = samples;
+            img.curves.push_back(c);
+        } else if (!std::strcmp(kw, "cubic") || !std::strcmp(kw, "quad")) {
+            const bool cubic = kw[0] == 'c';
+            const int need = cubic ? 8 : 6;
+            const int n = std::sscanf(rest, "%f %f %f %f %f %f %f %f %f",
+                                      &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8]);
+            if (img.curves.empty() || n < need) { ok = false; break; }
+            const float w = n > need ? v[need] : 1.0f;
+            const BezierSegment b = cubic ? BezierSegment::cubic(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], w)
+                                          : BezierSegment::quadratic(v[0], v[1], v[2], v[3], v[4], v[5], w);
+            img.segments.push_back(toRecord(b));
+            img.curves.back().segmentCount++;
+        } else if (!std::strcmp(kw, "preset")) {
+            double sens = 0;
+            if (std::sscanf(rest, "%63s %lf %63s", name, &sens, extra) < 2) { ok = false; break; }
+            PresetRecord p{};
+            setName(p.name, name);
+            p.sensitivity = sens;
+            p.curve = -1;
+            img.presets.push_back(p);
+            img.pendingCurveNames.push_back(extra);
+        } else if (!std::strcmp(kw, "headless")) {
+            img.flags |= kProfileHeadless;
+        } else {
+            ok = false;
+            break;
+        }
+    }
+    std::fclose(f);
+    if (!ok) { std::fprintf(stderr, "%s:%d: parse error\n", path, lineNo); return false; }
+
+    for (size_t i = 0; i < img.presets.size(); ++i) {
+        const std::string& want = img.pendingCurveNames[i];
+        if (want.empty()) continue;
+        for (size_t c = 0; c < img.curves.size(); ++c)
+            if (want == img.curves[c].name) img.presets[i].curve = int32_t(c);
+        if (img.presets[i].curve < 0) {
+            std::fprintf(stderr, "preset '%s': unknown curve '%s'\n", img.presets[i].name, want.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static int dump(const char* path) {
+    std::string err;
+    auto p = Profile::load(path, &err);
+    if (!p) { std::fprintf(stderr, "%s: %s\n", path, err.c_str()); return 1; }
+    std::printf("%s: version %u, %zu presets, %zu curves%s\n", path, unsigned(p->header().version),
+                p->presetCount(), p->curveCount(), (p->flags() & kProfileHeadless) ? ", headless" : "");
+    for (size_t i = 0; i < p->presetCount(); ++i) {
+        const PresetRecord& r = p->preset(i);
+        std::printf("  preset %-24.24s %.7f%s%s\n", r.name, r.sensitivity, r.curve >= 0 ? "  curve=" : "",
+                    r.curve >= 0 ? p->curveRecord(size_t(r.curve)).name : "");
+    }
+    for (size_t i = 0; i < p->curveCount(); ++i) {
+        const CurveRecord& c = p->curveRecord(i);
+        float x = 0, y = 0;
+        if (const Trajectory* t = p->curve(int32_t(i))) t->at(0.5f, x, y);
+        std::printf("  curve  %-24.24s %u segs, %.1f ms, mid=(%.2f, %.2f)\n", c.name, c.segmentCount,
+                    c.strokeUs / 1000.0, x, y);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && !std::strcmp(argv[1], "defaults")) return writeImage(defaults(), argv[2]) ? 0 : 1;
+    if (argc == 4 && !std::strcmp(argv[1], "build")) {
+        Image img;
+        return parse(argv[2], img) && writeImage(img, argv[3]) && dump(argv[3]) == 0 ? 0 : 1;
+    }
+    if (argc == 3 && !std::strcmp(argv[1], "dump")) return dump(argv[2]);
+    std::fprintf(stderr, "usage: ProfileTool defaults <out.rmp> | build <in.txt> <out.rmp> | dump <file.rmp>\n");
+    return 2;
+}
@@ -0,0 +1,209 @@
+// ReactorBench.cpp — input reactor vs GetAsyncKeyState-style polling: press-to-first-motion latency and idle CPU
+//   g++ -std=c++17 -O2 -pthread tools/ReactorBench.cpp -o ReactorBench      (Linux)
+//   cl /EHsc /std:c++17 tools\ReactorBench.cpp user32.lib                   (Windows)
+//   ReactorBench [--presses=<n>] [--idle-s=<s>] [--max-us=<us>]
+// A mock device presses and releases the left button. With the reactor it does so through
+// Reactor::inject(), which wakes the reactor exactly as a device event does; the handler wakes a
+// parked motion thread, whose first move ends the measurement. The polling model is the code the
+// reactor replaced: a button thread reading the key state every 1 ms and a hotkey thread every
+// 10 ms. Idle CPU is process CPU time over --idle-s seconds with nothing pressed.
+// Exit status is 1 when the reactor's p99 latency passes --max-us or the reactor woke while idle.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../core/Clock.h"
+#include "../core/Reactor.h"
+#include "../core/Telemetry.h"
+
+#ifndef _WIN32
+#include <ctime>
+#endif
+
+using namespace redmouse;
+
+static int64_t processCpuNs() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+    auto ns = [](const FILETIME& f) { return int64_t((uint64_t(f.dwHighDateTime) << 32) | f.dwLowDateTime) * 100; };
+    return ns(kernel) + ns(user);
+#else
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+// Stands in for the motion thread: parked until woken, then "moves" once per press.
+struct MotionThread {
+    WakeEvent wake;
+    std::atomic<bool> quit{false};
+    std::atomic<int64_t> firstMoveNs{0};
+    const std::atomic<bool>* held = nullptr; // the button as the input side last saw it
+    std::thread th;
+
+    void start(const std::atomic<bool>* h) {
+        held = h;
+        th = std::thread([this] {
+            SteadyClock clock;
+            while (!quit.load(std::memory_order_acquire)) {
+                wake.clear(); // then check: a press signalled before this line is still seen below
+                if (held->load(std::memory_order_acquire) && firstMoveNs.load(std::memory_order_acquire) == 0) {
+                    firstMoveNs.store(steadyNowNs(), std::memory_order_release);
+                    continue;
+                }
+                clock.sleepUntil(clock.nowNs() + 1000000000, 0, &wake);
+            }
+        });
+    }
+    void stop() {
+        quit.store(true, std::memory_order_release);
+        wake.signal();
+        if (th.joinable()) th.join();
+    }
+};
+
+struct Result {
+    LogHistogram latency;
+    double idleCpuPct = 0;
+    double idleWakeupsPerS = 0;
+};
+
+// Presses, waits for the first move, releases and waits until the release has been seen: a poller
+// would otherwise miss a release and press that both fall between two of its polls.
+template <class Press, class Release>
+static void runPresses(int presses, MotionThread& motion, Press press, Release release, LogHistogram& out) {
+    for (int i = 0; i < presses; ++i) {
+        motion.firstMoveNs.store(0, std::memory_order_relaxed);
+        const int64_t t0 = steadyNowNs();
+        press();
+        while (motion.firstMoveNs.load(std::memory_order_acquire) == 0 && steadyNowNs() - t0 < 1000000000)
+            std::this_thread::yield();
+        if (const int64_t t1 = motion.firstMoveNs.load(std::memory_order_acquire)) out.record(uint64_t(t1 - t0));
+        release();
+        const int64_t r0 = steadyNowNs();
+        while (motion.held->load(std::memory_order_acquire) && steadyNowNs() - r0 < 1000000000)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        std::this_thread::sleep_for(std::chrono::microseconds(2000 + (i * 7919) % 3000));
+    }
+}
+
+static Result reactorModel(int presses, double idleS, uint64_t& idleWakeups, int& devices) {
+    Result r;
+    std::atomic<bool> held{false};
+    MotionThread motion;
+    Reactor reactor([&](const InputEvent& e) {
+        if (e.key != Key::LButton) return;
+        held.store(e.down, std::memory_order_release);
+        if (e.down) motion.wake.signal();
+    });
+    motion.start(&held);
+    if (!reactor.start()) { motion.stop(); idleWakeups = UINT64_MAX; return r; }
+    devices = reactor.deviceCount();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const uint64_t w0 = reactor.wakeups();
+    const int64_t c0 = processCpuNs(), t0 = steadyNowNs();
+    std::this_thread::sleep_for(std::chrono::duration<double>(idleS));
+    const int64_t c1 = processCpuNs(), t1 = steadyNowNs();
+    idleWakeups = reactor.wakeups() - w0;
+    r.idleCpuPct = 100.0 * double(c1 - c0) / double(t1 - t0);
+    r.idleWakeupsPerS = double(idleWakeups) / (double(t1 - t0) * 1e-9);
+
+    runPresses(presses, motion, [&] { reactor.inject(Key::LButton, true); },
+               [&] { reactor.inject(Key::LButton, false); }, r.latency);
+    reactor.stop();
+    motion.stop();
+    return r;
+}
+
+static Result pollingModel(int presses, double idleS) {
+    Result r;
+    std::atomic<bool> keyState{false}, held{false}, quit{false};
+    std::atomic<uint64_t> polls{0};
+    MotionThread motion;
+    motion.start(&held);
+    // mouseProc: GetAsyncKeyState(VK_LBUTTON) then Sleep(1).
+    std::thread button([&] {
+        while (!quit.load(std::memory_order_acquire)) {
+            const bool down = keyState.load(std::memory_order_acquire);
+            if (down != held.load(std::memory_order_relaxed)) {
+                held.store(down, std::memory_order_release);
+                if (down) motion.wake.signal();
+            }
+            polls.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    // keyboardProc: ten-plus hotkeys, then Sleep(10).
+    std::thread hotkeys([&] {
+        while (!quit.load(std::memory_order_acquire)) {
+            polls.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const uint64_t p0 = polls.load();
+    const int64_t c0 = processCpuNs(), t0 = steadyNowNs();
+    std::this_thread::sleep_for(std::chrono::duration<double>(idleS));
+    const int64_t c1 = processCpuNs(), t1 = steadyNowNs();
+    r.idleCpuPct = 100.0 * double(c1 - c0) / double(t1 - t0);
+    r.idleWakeupsPerS = double(polls.load() - p0) / (double(t1 - t0) * 1e-9);
+
+    runPresses(presses, motion, [&] { keyState.store(true, std::memory_order_release); },
+               [&] { keyState.store(false, std::memory_order_release); }, r.latency);
+    quit.store(true, std::memory_order_release);
+    button.join();
+    hotkeys.join();
+    motion.stop();
+    return r;
+}
+
+static void printRow(const char* name, const Result& r) {
+    std::printf("%-8s %9.1f %9.1f %9.1f %9.1f %9.3f %10.1f\n", name, r.latency.percentile(0.50) / 1e3,
+                r.latency.percentile(0.90) / 1e3, r.latency.percentile(0.99) / 1e3, r.latency.maxValue() / 1e3,
+                r.idleCpuPct, r.idleWakeupsPerS);
+}
+
+int main(int argc, char** argv) {
+    int presses = 300;
+    double idleS = 2.0, maxUs = -1;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strncmp(a, "--presses=", 10) == 0) presses = std::max(1, std::atoi(a + 10));
+        else if (std::strncmp(a, "--idle-s=", 9) == 0) idleS = std::max(0.1, std::atof(a + 9));
+        else if (std::strncmp(a, "--max-us=", 9) == 0) maxUs = std::atof(a + 9);
+        else { std::fprintf(stderr, "unknown option: %s\n", a); return 2; }
+    }
+
+    uint64_t idleWakeups = 0;
+    int devices = 0;
+    const Result reactor = reactorModel(presses, idleS, idleWakeups, devices);
+    if (idleWakeups == UINT64_MAX) { std::fprintf(stderr, "reactor failed to start\n"); return 2; }
+    const Result polling = pollingModel(presses, idleS);
+
+    std::printf("presses=%d idle=%.1fs mock device (%d real input sources open)\n", presses, idleS, devices);
+    std::printf("%-8s %9s %9s %9s %9s %9s %10s\n", "model", "p50_us", "p90_us", "p99_us", "max_us", "idle_cpu%",
+                "wakeups/s");
+    printRow("reactor", reactor);
+    printRow("polling", polling);
+
+    bool fail = false;
+    if (idleWakeups > 0) {
+        std::printf("FAIL: reactor woke %llu times while idle\n", (unsigned long long)idleWakeups);
+        fail = true;
+    }
+    if (maxUs >= 0 && reactor.latency.percentile(0.99) / 1e3 > maxUs) {
+        std::printf("FAIL: reactor p99 %.1f us > %.1f us\n", reactor.latency.percentile(0.99) / 1e3, maxUs);
+        fail = true;
+    }
+    return fail ? 1 : 0;
+}
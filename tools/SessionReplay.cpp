@@ -0,0 +1,286 @@
+// SessionReplay.cpp — replay recorded sessions (--record=<file.rms>) through the motion core under a virtual clock
+//   g++ -std=c++17 -O2 -pthread tools/SessionReplay.cpp -o SessionReplay   (Linux)
+//   cl /EHsc /std:c++17 tools\SessionReplay.cpp                           (Windows)
+//   SessionReplay replay <file.rms> [--integrator=fixed|clamped|q32] [--dump]
+//   SessionReplay generate <out.rms> [minutes] [--integrator=...] [--rate=Hz] [--start=zero|immediate|half|carry]
+//
+// replay feeds every recorded tick (scheduled/actual time, missed count) back into an integrator
+// and compares its output with what was emitted live. With the recorded integrator any mismatch is
+// a regression (exit 1); with another one it shows how that integrator would have behaved on the
+// same timing. It also reports tick lateness and press-to-first-pixel latency from the log.
+// generate writes a synthetic session through the real recorder, for load tests and CI.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "../core/InputSink.h"
+#include "../core/MappedFile.h"
+#include "../core/MotionIntegrator.h"
+#include "../core/Presets.h"
+#include "../core/SessionLog.h"
+#include "../core/Telemetry.h"
+
+using namespace redmouse;
+
+namespace {
+
+const char* integratorName(SessionIntegrator k) {
+    switch (k) {
+    case SessionIntegrator::Fixed:      return "fixed";
+    case SessionIntegrator::Clamped:    return "clamped";
+    case SessionIntegrator::FixedPoint: return "q32";
+    }
+    return "?";
+}
+
+bool parseIntegrator(const char* s, SessionIntegrator& k) {
+    if (!std::strcmp(s, "fixed"))   { k = SessionIntegrator::Fixed;      return true; }
+    if (!std::strcmp(s, "clamped")) { k = SessionIntegrator::Clamped;    return true; }
+    if (!std::strcmp(s, "q32"))     { k = SessionIntegrator::FixedPoint; return true; }
+    return false;
+}
+
+// -------- replay --------
+
+struct ReplayStats {
+    uint64_t ticks = 0, inputs = 0, settings = 0, resumes = 0, moves = 0, gaps = 0;
+    int64_t  recordedPx = 0, replayedPx = 0;
+    uint64_t mismatches = 0;
+    int64_t  firstMismatchNs = -1;
+    int64_t  firstNs = 0, lastNs = 0;
+    LogHistogram late, pressToPixel;
+    bool     truncated = false;
+};
+
+void dumpRecord(const SessionRecord& r, int64_t t0) {
+    const double t = double(r.tNs - t0) * 1e-6;
+    switch (r.kind) {
+    case SessionKind::Input:
+        std::printf("%12.3f input    key=%u %s\n", t, unsigned(r.key), (r.flags & kSessionDown) ? "down" : "up");
+        break;
+    case SessionKind::Settings:
+        std::printf("%12.3f settings sens=%.7f enabled=%d curve=%d pattern=%d\n", t, r.sensitivity,
+                    (r.flags & kSessionEnabled) ? 1 : 0, r.curve, (r.flags & kSessionCurvePattern) ? 1 : 0);
+        break;
+    case SessionKind::Resume: std::printf("%12.3f resume\n", t); break;
+    case SessionKind::Tick:
+        std::printf("%12.3f tick     late=%lldns missed=%u dy=%d\n", t, (long long)(r.tNs - r.scheduledNs), r.count, r.dy);
+        break;
+    case SessionKind::Move: std::printf("%12.3f move     dx=%d dy=%d\n", t, r.dx, r.dy); break;
+    case SessionKind::Gap:  std::printf("%12.3f gap      %u records lost\n", t, r.count); break;
+    }
+}
+
+template <class Integrator>
+ReplayStats replay(const uint8_t* data, size_t size, bool compare, bool dump) {
+    SessionReader in;
+    in.open(data, size);
+    VirtualClock clk(in.header().startNs);
+    RecordingSink sink(1u << 16);
+    sink.setTimeSource([](const void* c) { return static_cast<const VirtualClock*>(c)->nowNs(); }, &clk);
+
+    ReplayStats st;
+    st.firstNs = st.lastNs = in.header().startNs;
+    Integrator integ;
+    integ.reset(clk.nowNs());
+    const StartPolicy policy = StartPolicy(in.header().startPolicy);
+    double sens = kDefaultSensitivity;
+    uint64_t index = 0;
+    int64_t pressNs = -1;
+
+    SessionRecord r;
+    while (in.next(r)) {
+        if (dump) dumpRecord(r, in.header().startNs);
+        clk.set(std::max(clk.nowNs(), r.tNs));
+        st.lastNs = std::max(st.lastNs, r.tNs);
+        switch (r.kind) {
+        case SessionKind::Input:
+            ++st.inputs;
+            if (r.key == Key::LButton && (r.flags & kSessionDown)) pressNs = r.tNs;
+            break;
+        case SessionKind::Settings: ++st.settings; sens = r.sensitivity; break;
+        case SessionKind::Resume:   ++st.resumes; integ.start(r.tNs, policy); break;
+        case SessionKind::Move:     ++st.moves; break;
+        case SessionKind::Gap:      st.gaps += r.count; break;
+        case SessionKind::Tick: {
+            ++st.ticks;
+            const int64_t late = r.tNs - r.scheduledNs;
+            st.late.record(uint64_t(late > 0 ? late : 0));
+            const StepResult s = integ.step(sens, Tick{ index++, r.scheduledNs, r.tNs, r.count, r.periodNs });
+            if (s.dy) sink.moveRelative(0, s.dy);
+            st.recordedPx += r.dy;
+            st.replayedPx += s.dy;
+            if (compare && s.dy != r.dy && st.mismatches++ == 0) st.firstMismatchNs = r.tNs;
+            if (r.dy > 0 && pressNs >= 0) {
+                st.pressToPixel.record(uint64_t(r.tNs - pressNs));
+                pressNs = -1;
+            }
+            break;
+        }
+        }
+    }
+    st.truncated = in.truncatedTail();
+    return st;
+}
+
+int replayCommand(const char* path, int argc, char** argv) {
+    bool dump = false, override = false;
+    SessionIntegrator kind = SessionIntegrator::FixedPoint;
+    for (int i = 0; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--dump")) dump = true;
+        else if (!std::strncmp(argv[i], "--integrator=", 13) && parseIntegrator(argv[i] + 13, kind)) override = true;
+        else { std::fprintf(stderr, "unknown option %s\n", argv[i]); return 2; }
+    }
+    MappedFile map(path);
+    SessionReader probe;
+    std::string err;
+    if (!map.ok() || !probe.open(map.data(), map.size(), &err)) {
+        std::fprintf(stderr, "%s: %s\n", path, map.ok() ? err.c_str() : "cannot open/map");
+        return 2;
+    }
+    const SessionHeader& h = probe.header();
+    const SessionIntegrator recorded = SessionIntegrator(h.integrator);
+    if (!override) kind = recorded;
+    const bool compare = kind == recorded;
+
+    const auto wall0 = std::chrono::steady_clock::now();
+    ReplayStats st;
+    switch (kind) {
+    case SessionIntegrator::Fixed:      st = replay<FixedStepIntegrator>(map.data(), map.size(), compare, dump); break;
+    case SessionIntegrator::Clamped:    st = replay<ClampedDtIntegrator>(map.data(), map.size(), compare, dump); break;
+    case SessionIntegrator::FixedPoint: st = replay<FixedPointIntegrator>(map.data(), map.size(), compare, dump); break;
+    }
+    const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    const double spanS = double(st.lastNs - st.firstNs) * 1e-9;
+
+    std::printf("%s: %.1f s recorded, %s @ %u Hz, emit=%s, start=%s, %zu bytes (%.2f B/tick)\n", path, spanS,
+                integratorName(recorded), h.rateHz, h.eventEmit ? "event" : "tick",
+                startPolicyName(StartPolicy(h.startPolicy)), map.size(),
+                st.ticks ? double(map.size() - sizeof(SessionHeader)) / double(st.ticks) : 0.0);
+    std::printf("  records: %llu ticks, %llu inputs, %llu settings, %llu resumes, %llu moves, %llu lost%s\n",
+                (unsigned long long)st.ticks, (unsigned long long)st.inputs, (unsigned long long)st.settings,
+                (unsigned long long)st.resumes, (unsigned long long)st.moves, (unsigned long long)st.gaps,
+                st.truncated ? ", truncated tail" : "");
+    std::printf("  tick lateness p50/p99/p99.9/max: %.0f/%.0f/%.0f/%.0f us\n", st.late.percentile(0.50) / 1e3,
+                st.late.percentile(0.99) / 1e3, st.late.percentile(0.999) / 1e3, st.late.maxValue() / 1e3);
+    if (st.pressToPixel.count())
+        std::printf("  press -> first pixel p50/p99/max: %.2f/%.2f/%.2f ms over %llu presses\n",
+                    st.pressToPixel.percentile(0.50) / 1e6, st.pressToPixel.percentile(0.99) / 1e6,
+                    st.pressToPixel.maxValue() / 1e6, (unsigned long long)st.pressToPixel.count());
+    std::printf("  replay (%s): %lld px recorded, %lld px replayed", integratorName(kind),
+                (long long)st.recordedPx, (long long)st.replayedPx);
+    if (compare) std::printf(", %llu mismatching ticks", (unsigned long long)st.mismatches);
+    if (st.firstMismatchNs >= 0) std::printf(" (first at %.3f s)", double(st.firstMismatchNs - st.firstNs) * 1e-9);
+    std::printf("\n  replayed in %.3f s (%.0fx real time)\n", wallS, wallS > 0 ? spanS / wallS : 0.0);
+
+    // Lost records make the replay diverge legitimately; only a clean log can fail the check.
+    return compare && st.mismatches && !st.gaps ? 1 : 0;
+}
+
+// -------- generate --------
+
+// Wake-ups land 0..maxLateNs late (fixed-seed LCG), like a loaded desktop.
+class JitterClock {
+public:
+    int64_t nowNs() const { return t; }
+    void sleepUntil(int64_t deadlineNs, int64_t) {
+        if (deadlineNs > t) t = deadlineNs;
+        t += int64_t(next() % uint64_t(kMaxLateNs + 1));
+    }
+    void advance(int64_t ns) { t += ns; }
+    void set(int64_t ns) { t = ns; }
+    uint64_t next() { return (rng = rng * 6364136223846793005ull + 1442695040888963407ull) >> 33; }
+
+private:
+    static constexpr int64_t kMaxLateNs = 300000;
+    int64_t  t = 0;
+    uint64_t rng = 0x5eed;
+};
+
+// Mirrors the apps' motion loop: press, resume, tick until release; a preset change every few holds.
+template <class Integrator>
+int generate(const char* path, double minutes, SessionIntegrator kind, uint32_t rateHz, StartPolicy policy) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) { std::fprintf(stderr, "cannot write %s\n", path); return 2; }
+    TickScheduler<JitterClock>::Config cfg;
+    cfg.rateHz = rateHz;
+    cfg.overrun = Overrun::CatchUp;
+    cfg.maxCatchUp = 10;
+    TickScheduler<JitterClock> sched(cfg);
+    JitterClock& clk = sched.clock();
+    SessionRecorder rec(1u << 16);
+    rec.start(f, rateHz, kind, false, clk.nowNs(), policy);
+
+    Integrator integ;
+    MotionSettings s;
+    s.enabled = true;
+    rec.settings(clk.nowNs(), s);
+    const int64_t endNs = int64_t(minutes * 60e9);
+    uint64_t ticks = 0, holds = 0;
+    int64_t px = 0;
+    const auto wall0 = std::chrono::steady_clock::now();
+    while (clk.nowNs() < endNs) {
+        clk.advance(200000000 + int64_t(clk.next() % 800) * 1000000);
+        if (++holds % 8 == 0) {
+            const int preset = int(clk.next() % kPresetCount);
+            rec.input(InputEvent{ Key(int(Key::F2) + preset), true, clk.nowNs() });
+            rec.input(InputEvent{ Key(int(Key::F2) + preset), false, clk.nowNs() + 80000000 });
+            s.sensitivity = kPresets[preset];
+            rec.settings(clk.nowNs(), s);
+        }
+        rec.input(InputEvent{ Key::LButton, true, clk.nowNs() });
+        sched.reset();
+        integ.start(clk.nowNs(), policy);
+        rec.resume(clk.nowNs());
+        const int64_t releaseNs = clk.nowNs() + 300000000 + int64_t(clk.next() % 3000) * 1000000;
+        while (clk.nowNs() < releaseNs) {
+            const Tick t = sched.wait();
+            const StepResult r = integ.step(s.sensitivity, t);
+            rec.tick(t, r.dy);
+            px += r.dy;
+            if (++ticks % 8192 == 0) rec.flush(); // virtual time outruns the writer
+        }
+        rec.input(InputEvent{ Key::LButton, false, clk.nowNs() });
+    }
+    rec.stop();
+    const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    std::printf("%s: %.1f min, %llu holds, %llu ticks, %lld px, %llu bytes (%.2f B/tick), %llu lost, %.2f s\n",
+                path, minutes, (unsigned long long)holds, (unsigned long long)ticks, (long long)px,
+                (unsigned long long)rec.bytesWritten(), ticks ? double(rec.bytesWritten()) / double(ticks) : 0.0,
+                (unsigned long long)rec.dropped(), wallS);
+    return 0;
+}
+
+int generateCommand(const char* path, int argc, char** argv) {
+    double minutes = 10;
+    uint32_t rateHz = 1000;
+    SessionIntegrator kind = SessionIntegrator::FixedPoint;
+    StartPolicy policy = StartPolicy::Zero;
+    for (int i = 0; i < argc; ++i) {
+        if (!std::strncmp(argv[i], "--integrator=", 13) && parseIntegrator(argv[i] + 13, kind)) continue;
+        if (!std::strncmp(argv[i], "--start=", 8) && parseStartPolicy(argv[i] + 8, policy)) continue;
+        if (!std::strncmp(argv[i], "--rate=", 7)) { rateHz = uint32_t(std::max(50, std::atoi(argv[i] + 7))); continue; }
+        if (argv[i][0] != '-') { minutes = std::atof(argv[i]); continue; }
+        std::fprintf(stderr, "unknown option %s\n", argv[i]);
+        return 2;
+    }
+    switch (kind) {
+    case SessionIntegrator::Fixed:   return generate<FixedStepIntegrator>(path, minutes, kind, rateHz, policy);
+    case SessionIntegrator::Clamped: return generate<ClampedDtIntegrator>(path, minutes, kind, rateHz, policy);
+    default:                         return generate<FixedPointIntegrator>(path, minutes, kind, rateHz, policy);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && !std::strcmp(argv[1], "replay")) return replayCommand(argv[2], argc - 3, argv + 3);
+    if (argc >= 3 && !std::strcmp(argv[1], "generate")) return generateCommand(argv[2], argc - 3, argv + 3);
+    std::fprintf(stderr, "usage: SessionReplay replay <file.rms> [--integrator=fixed|clamped|q32] [--dump]\n"
+                         "       SessionReplay generate <out.rms> [minutes] [--integrator=...] [--rate=Hz] [--start=zero|immediate|half|carry]\n");
+    return 2;
+}
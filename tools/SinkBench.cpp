@@ -0,0 +1,94 @@
+// SinkBench.cpp — injection cost per backend: ns per move and syscalls per emitted pixel
+//   g++ -std=c++17 -O2 -pthread tools/SinkBench.cpp -o SinkBench      (Linux)
+//   cl /EHsc /std:c++17 tools\SinkBench.cpp user32.lib               (Windows)
+//   SinkBench [mock|uinput|sendinput] [moves] [pixelsPerMove]
+//             [--inject=batch|coalesce] [--budget-us=<us>] [--interval-us=<us>] [--max-p99-us=<us>]
+// --inject puts the injector queue in front of the backend; --interval-us paces the producer
+// like the motion loop would (e.g. 1000 for the curve player at 1 kHz). syscalls_saved counts the
+// backend's own syscalls against one per move, so it is only printed for sendinput/uinput.
+// Exit status is 1 when the queued moves' p99 delay passes --max-p99-us, 2 when moves were dropped.
+// The maximum is printed but not gated: one descheduled injector wake-up sets it.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "../core/InjectQueue.h"
+
+int main(int argc, char** argv) {
+    const char* kind = "mock";
+    long moves = 100000;
+    int  step = 1;
+    redmouse::InjectMode mode = redmouse::InjectMode::Direct;
+    long budgetUs = 1000, intervalUs = 0, maxP99Us = -1;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strcmp(a, "--inject=batch") == 0) mode = redmouse::InjectMode::Batch;
+        else if (std::strcmp(a, "--inject=coalesce") == 0) mode = redmouse::InjectMode::Coalesce;
+        else if (std::strncmp(a, "--budget-us=", 12) == 0) budgetUs = std::atol(a + 12);
+        else if (std::strncmp(a, "--interval-us=", 14) == 0) intervalUs = std::atol(a + 14);
+        else if (std::strncmp(a, "--max-p99-us=", 13) == 0) maxP99Us = std::atol(a + 13);
+        else if (positional == 0) { kind = a; ++positional; }
+        else if (positional == 1) { moves = std::atol(a); ++positional; }
+        else if (positional == 2) { step = std::atoi(a); ++positional; }
+    }
+
+    std::unique_ptr<redmouse::InputSink> sink = redmouse::makeSink(kind);
+    if (!sink) {
+        std::fprintf(stderr, "sink '%s' unavailable (uinput needs write access to /dev/uinput)\n", kind);
+        return 1;
+    }
+    redmouse::QueuedSink* queue = nullptr;
+    if (mode != redmouse::InjectMode::Direct) {
+        redmouse::QueuedSink::Options qo;
+        qo.mode = mode;
+        qo.budgetNs = int64_t(budgetUs) * 1000;
+        auto q = std::make_unique<redmouse::QueuedSink>(std::move(sink), qo);
+        queue = q.get();
+        sink = std::move(q);
+    }
+
+    // Alternate direction so a real pointer stays put.
+    using clk = std::chrono::steady_clock;
+    // Only the producer's moveRelative() calls are timed, not the pacing sleeps.
+    const auto t0 = clk::now();
+    clk::duration spent{};
+    for (long i = 0; i < moves; ++i) {
+        const auto c0 = clk::now();
+        sink->moveRelative(0, (i & 1) ? -step : step);
+        spent += clk::now() - c0;
+        if (intervalUs > 0) std::this_thread::sleep_until(t0 + std::chrono::microseconds(intervalUs * (i + 1)));
+    }
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count());
+    if (queue) queue->stop();
+
+    const redmouse::SinkStats s = queue ? queue->backend().stats() : sink->stats();
+    std::printf("sink=%s moves=%ld px/move=%d\n", sink->name(), moves, step);
+    std::printf("  ns/move        %10.1f\n", moves ? ns / moves : 0.0);
+    std::printf("  syscalls       %10llu\n", (unsigned long long)s.syscalls);
+    std::printf("  events         %10llu\n", (unsigned long long)s.events);
+    std::printf("  pixels         %10llu\n", (unsigned long long)s.pixels);
+    std::printf("  dropped        %10llu\n", (unsigned long long)(s.dropped + (queue ? sink->stats().dropped : 0)));
+    std::printf("  syscalls/px    %10.4f\n", s.pixels ? double(s.syscalls) / double(s.pixels) : 0.0);
+    if (queue) {
+        const redmouse::InjectorStats q = queue->injectorStats();
+        std::printf("  budget_us      %10ld\n", budgetUs);
+        std::printf("  batches        %10llu  (%.2f moves/batch)\n", (unsigned long long)q.batches,
+                    q.batches ? double(q.moves) / double(q.batches) : 0.0);
+        if (q.backendSyscalls) std::printf("  syscalls_saved %10llu\n", (unsigned long long)q.syscallsSaved);
+        else std::printf("  syscalls_saved        n/a  (%s makes no syscalls)\n", queue->backend().name());
+        std::printf("  wakeups        %10llu\n", (unsigned long long)q.wakeups);
+        std::printf("  delay_us       p50=%.1f p99=%.1f max=%.1f\n",
+                    q.delayP50Ns / 1e3, q.delayP99Ns / 1e3, q.delayMaxNs / 1e3);
+        if (s.dropped || sink->stats().dropped) return 2;
+        if (maxP99Us >= 0 && q.delayP99Ns > uint64_t(maxP99Us) * 1000) {
+            std::printf("FAIL: p99 delay %.1f us > %ld us\n", q.delayP99Ns / 1e3, maxP99Us);
+            return 1;
+        }
+        return 0;
+    }
+    return s.dropped ? 2 : 0;
+}